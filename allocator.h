@@ -0,0 +1,158 @@
+#pragma once
+
+#include <vector>
+#include <string>
+#include <new>
+#include <cstddef>
+#include <cstdint>
+#include <type_traits>
+#include <atomic>
+#include <sys/mman.h>
+
+static constexpr size_t CACHE_LINE_SIZE = 64;
+static constexpr size_t HUGE_PAGE_SIZE = 2 * 1024 * 1024;
+
+enum MemoryPolicy
+{
+    DEFAULT_ALLOCATION,
+    CACHE_LINE_ALIGNED,
+    HUGE_PAGES,
+};
+
+std::string memory_policy_to_string(MemoryPolicy policy)
+{
+    if (policy == MemoryPolicy::DEFAULT_ALLOCATION)
+    {
+        return "default";
+    }
+    else if (policy == MemoryPolicy::CACHE_LINE_ALIGNED)
+    {
+        return "aligned";
+    }
+    else if (policy == MemoryPolicy::HUGE_PAGES)
+    {
+        return "huge_pages";
+    }
+    else
+    {
+        return "";
+    }
+}
+
+// bytes that ended up in explicit huge pages (MAP_HUGETLB), in regions advised for
+// transparent huge pages, or in cache line aligned heap memory because the array was too small;
+// atomic since indices may be built from several threads at once
+struct HugePageStats
+{
+    std::atomic<size_t> explicit_bytes = 0;
+    std::atomic<size_t> transparent_bytes = 0;
+    std::atomic<size_t> fallback_bytes = 0;
+};
+inline HugePageStats huge_page_stats;
+
+inline size_t round_up(size_t bytes, size_t alignment)
+{
+    return (bytes + alignment - 1) / alignment * alignment;
+}
+
+// tries explicit huge pages first, then a 2MB aligned mapping advised for transparent huge pages
+void *map_huge_pages(size_t bytes)
+{
+    size_t size = round_up(bytes, HUGE_PAGE_SIZE);
+    int flags = MAP_PRIVATE | MAP_ANONYMOUS;
+#ifdef MAP_HUGETLB
+    void *p = mmap(nullptr, size, PROT_READ | PROT_WRITE, flags | MAP_HUGETLB, -1, 0);
+    if (p != MAP_FAILED)
+    {
+        huge_page_stats.explicit_bytes += size;
+        return p;
+    }
+#endif
+    // over allocate by one huge page and cut off the unaligned head and tail
+    size_t padded = size + HUGE_PAGE_SIZE;
+    char *raw = (char *)mmap(nullptr, padded, PROT_READ | PROT_WRITE, flags, -1, 0);
+    if (raw == MAP_FAILED)
+    {
+        throw std::bad_alloc();
+    }
+    char *aligned = (char *)round_up((uintptr_t)raw, HUGE_PAGE_SIZE);
+    size_t head = aligned - raw;
+    size_t tail = padded - head - size;
+    if (head > 0)
+        munmap(raw, head);
+    if (tail > 0)
+        munmap(aligned + size, tail);
+#ifdef MADV_HUGEPAGE
+    // failure only means that the kernel does not support transparent huge pages
+    madvise(aligned, size, MADV_HUGEPAGE);
+#endif
+    huge_page_stats.transparent_bytes += size;
+    return aligned;
+}
+
+void unmap_huge_pages(void *p, size_t bytes)
+{
+    munmap(p, round_up(bytes, HUGE_PAGE_SIZE));
+}
+
+// stateful allocator, the policy is chosen when the index is built and moves with the container
+template <typename T>
+struct PolicyAllocator
+{
+    using value_type = T;
+    using propagate_on_container_copy_assignment = std::true_type;
+    using propagate_on_container_move_assignment = std::true_type;
+    using propagate_on_container_swap = std::true_type;
+
+    PolicyAllocator() noexcept : policy(MemoryPolicy::DEFAULT_ALLOCATION) {}
+    PolicyAllocator(MemoryPolicy _policy) noexcept : policy(_policy) {}
+
+    template <typename U>
+    PolicyAllocator(const PolicyAllocator<U> &other) noexcept : policy(other.policy) {}
+
+    T *allocate(size_t n)
+    {
+        size_t bytes = n * sizeof(T);
+        if (policy == MemoryPolicy::DEFAULT_ALLOCATION)
+        {
+            return static_cast<T *>(::operator new(bytes));
+        }
+        if (policy == MemoryPolicy::HUGE_PAGES && uses_huge_pages(bytes))
+        {
+            return static_cast<T *>(map_huge_pages(bytes));
+        }
+        if (policy == MemoryPolicy::HUGE_PAGES)
+        {
+            huge_page_stats.fallback_bytes += bytes;
+        }
+        return static_cast<T *>(::operator new(bytes, std::align_val_t(CACHE_LINE_SIZE)));
+    }
+
+    void deallocate(T *p, size_t n) noexcept
+    {
+        size_t bytes = n * sizeof(T);
+        if (policy == MemoryPolicy::DEFAULT_ALLOCATION)
+        {
+            ::operator delete(p);
+        }
+        else if (policy == MemoryPolicy::HUGE_PAGES && uses_huge_pages(bytes))
+        {
+            unmap_huge_pages(p, bytes);
+        }
+        else
+        {
+            ::operator delete(p, std::align_val_t(CACHE_LINE_SIZE));
+        }
+    }
+
+    // arrays smaller than a huge page would waste most of it
+    static bool uses_huge_pages(size_t bytes) { return bytes >= HUGE_PAGE_SIZE; }
+
+    template <typename U>
+    bool operator==(const PolicyAllocator<U> &other) const { return policy == other.policy; }
+
+    MemoryPolicy policy;
+};
+
+template <typename T>
+using PolicyVector = std::vector<T, PolicyAllocator<T>>;
@@ -4,6 +4,7 @@
 #include <sstream>
 #include <tuple>
 #include <vector>
+#include <memory>
 
 #include "common.h"
 #include "trie.h"
@@ -13,6 +14,10 @@
 #include "io.h"
 #include "word_challenge.h"
 #include "wordle.h"
+#include "prefix_completer.h"
+#include "fuzzy_search.h"
+#include "pattern_search.h"
+#include "benchmarks.h"
 
 bool check_word_count(uint word_length, RandomWordGenerator &word_gen)
 {
@@ -26,9 +31,12 @@ bool check_word_count(uint word_length, RandomWordGenerator &word_gen)
     return true;
 }
 
-struct WordChallengeApplication
+template <TraversableTrieGraph Graph>
+struct BasicWordChallengeApplication
 {
-    WordChallengeApplication(WordList &_words, int seed) : words(_words), word_challenge(words), word_gen(words, seed) {}
+    BasicWordChallengeApplication(WordList &_words, int seed, MemoryPolicy policy = MemoryPolicy::DEFAULT_ALLOCATION) : words(_words), word_challenge(words, true, policy), word_gen(words, seed) {}
+
+    BasicWordChallengeApplication(WordList &_words, int seed, std::vector<int> &node_order, MemoryPolicy policy = MemoryPolicy::DEFAULT_ALLOCATION) : words(_words), word_challenge(words, node_order, policy), word_gen(words, seed) {}
 
     void play_auto_mode(int repeats, int word_length)
     {
@@ -90,14 +98,33 @@ struct WordChallengeApplication
     }
 
     WordList &words;
-    WordChallenge word_challenge;
+    BasicWordChallenge<Graph> word_challenge;
     RandomWordGenerator word_gen;
 };
 
-struct WordleApplication
+template <MembershipIndex WordIndex, TraversableTrieGraph Graph>
+struct BasicWordleApplication
 {
     // guesser must have different seed than word generation, otherwise he will guess it in the first try
-    WordleApplication(WordList &_words, int _seed, GuesserStrategy strategy) : seed(_seed), words(_words), wordle(words), word_gen(words, seed), guesser(words, seed + 1, strategy), guesser_strategy(strategy) {}
+    BasicWordleApplication(WordList &_words, int _seed, GuesserStrategy strategy, std::vector<int> _node_order = {}, MemoryPolicy _policy = MemoryPolicy::DEFAULT_ALLOCATION, double bloom_filter_fpr = 0) : seed(_seed), words(_words), wordle(bloom_filter_fpr > 0 ? BasicWordle<WordIndex>(words, bloom_filter_fpr) : BasicWordle<WordIndex>(words)), word_gen(words, seed), index(std::make_shared<BasicWordleIndex<Graph>>(words, _node_order, _policy)), guesser(index, seed + 1, strategy), guesser_strategy(strategy) {}
+
+    void use_candidate_engine(CandidateEngine engine)
+    {
+        candidate_engine = engine;
+        guesser.use_candidate_engine(engine);
+    }
+
+    void set_decision_tree_dir(std::string dir)
+    {
+        decision_tree_dir = dir;
+        guesser.decision_tree_dir = dir;
+    }
+
+    void set_opening_book(std::shared_ptr<const OpeningBook> book)
+    {
+        opening_book = book;
+        guesser.opening_book = book;
+    }
 
     bool check_word(uint word_length, std::string &guess)
     {
@@ -111,11 +138,38 @@ struct WordleApplication
         {
             std::string msg4 = guess + " is not a valid word from the dictionary \n";
             color_print(msg4, YELLOW);
+            print_similar_words(word_length, guess);
             return false;
         }
         return true;
     }
 
+    void print_similar_words(uint word_length, std::string &guess)
+    {
+        static constexpr int MAX_DISTANCE = 2;
+        static constexpr int NUM_SUGGESTIONS = 5;
+        // only built once a guess is rejected
+        if (!fuzzy_search)
+        {
+            fuzzy_search = std::make_unique<FuzzySearch>(words);
+        }
+        std::stringstream ss;
+        int num_suggestions = 0;
+        for (auto &match : fuzzy_search->search(guess, MAX_DISTANCE))
+        {
+            std::string &word = words[match.word_index];
+            if (word.size() != word_length || num_suggestions == NUM_SUGGESTIONS)
+                continue;
+            ss << (num_suggestions == 0 ? "did you mean: " : ", ") << word;
+            num_suggestions++;
+        }
+        if (num_suggestions > 0)
+        {
+            ss << "\n";
+            color_print(ss, YELLOW);
+        }
+    }
+
     bool check_hint(uint word_length, std::string &hint)
     {
         bool ok = hint.size() == word_length;
@@ -181,8 +235,11 @@ struct WordleApplication
         std::stringstream ss;
 
         ss << "secret word has " << word_length << " letters\n";
+        ss << "type a prefix followed by * to get suggestions\n";
         color_print(ss, YELLOW);
 
+        PrefixCompleter completer = word_weights.empty() ? PrefixCompleter(words) : PrefixCompleter(words, std::vector<float>(word_weights));
+
         while (true)
         {
             std::cout << "\n";
@@ -191,6 +248,11 @@ struct WordleApplication
             color_print(ss, BLUE);
 
             std::string guess = io::get_user_input();
+            if (!guess.empty() && guess.back() == '*')
+            {
+                print_suggestions(completer, guess.substr(0, guess.size() - 1), word_length);
+                continue;
+            }
             if (!check_word(word_length, guess))
                 continue;
 
@@ -210,6 +272,22 @@ struct WordleApplication
         }
     }
 
+    void print_suggestions(PrefixCompleter &completer, std::string prefix, uint word_length)
+    {
+        static constexpr int NUM_SUGGESTIONS = 10;
+        WordList suggestions = completer.complete_words(prefix, NUM_SUGGESTIONS, word_length);
+        std::stringstream ss;
+        if (suggestions.empty())
+        {
+            ss << "no word of length " << word_length << " starts with " << prefix << "\n";
+        }
+        for (auto &s : suggestions)
+        {
+            ss << s << "\n";
+        }
+        color_print(ss, YELLOW);
+    }
+
     void play_as_keeper(uint word_length, uint max_guesses)
     {
         if (!check_word_count(word_length, word_gen))
@@ -272,25 +350,141 @@ struct WordleApplication
         }
     }
 
+    // settings of the interactive guesser for the guessers of a simulation
+    void configure_guesser(BasicRandomWordleGuesser<Graph> &sim_guesser)
+    {
+        sim_guesser.use_candidate_engine(candidate_engine);
+        sim_guesser.decision_tree_dir = decision_tree_dir;
+        sim_guesser.opening_book = opening_book;
+    }
+
+    int all_secrets_threads() const
+    {
+        return simulation_threads > 0 ? simulation_threads : default_num_threads();
+    }
+
+    // the games of one word length, in the order of secrets
+    struct SecretsEvaluation
+    {
+        int length;
+        std::vector<std::string> secrets;
+        std::vector<int> guesses;
+        std::vector<char> found;
+        double time;
+    };
+
+    // every distinct word of every length is the secret once, the games run on simulation_threads
+    // threads or on all hardware threads if it is 0
+    std::vector<SecretsEvaluation> evaluate_all_secrets(int max_guesses)
+    {
+        BasicParallelWordleSimulation<WordIndex, Graph> sim(index, max_guesses, seed + 1, guesser_strategy, all_secrets_threads());
+        sim.configure_guessers([&](BasicRandomWordleGuesser<Graph> &sim_guesser)
+                               { configure_guesser(sim_guesser); });
+        std::vector<SecretsEvaluation> evaluations;
+        for (uint len = 1; len < index->words_of_len.size(); len++)
+        {
+            std::vector<std::string> secrets;
+            for (int idx : index->words_of_len[len])
+            {
+                secrets.push_back(words[idx]);
+            }
+            std::sort(secrets.begin(), secrets.end());
+            secrets.erase(std::unique(secrets.begin(), secrets.end()), secrets.end());
+            if (secrets.empty())
+                continue;
+
+            sim.reset_logging();
+            double time = measureTimeMicroS([&]()
+                                            { sim.play(secrets); }) / 1000.0;
+            auto [guesses, visited, candidates, guess_time] = sim.get_log_data();
+            evaluations.push_back({(int)len, secrets, guesses, sim.found_secret, time});
+        }
+        return evaluations;
+    }
+
+    void play_all_secrets(int max_guesses)
+    {
+        static constexpr int NUM_HARDEST = 10;
+        std::cout << "strategy: " << strategy_to_string(guesser_strategy) << ", threads: " << all_secrets_threads() << "\n\n";
+        long long total_games = 0, total_guesses = 0, total_failures = 0;
+        double total_time = 0;
+        for (auto &[len, secrets, guesses, found, time] : evaluate_all_secrets(max_guesses))
+        {
+            // distribution[g] is the number of games won with g guesses
+            std::vector<int> distribution(max_guesses + 1, 0);
+            std::vector<int> order;
+            int failures = 0;
+            for (uint i = 0; i < secrets.size(); i++)
+            {
+                if (found[i])
+                    distribution[guesses[i]]++;
+                else
+                    failures++;
+                order.push_back(i);
+            }
+            // failures first, then by number of guesses
+            auto hardness = [&](int i)
+            { return std::make_pair(!found[i], guesses[i]); };
+            std::stable_sort(order.begin(), order.end(), [&](int a, int b)
+                             { return hardness(a) > hardness(b); });
+            long long sum_guesses = std::accumulate(guesses.begin(), guesses.end(), 0LL);
+
+            std::cout << "length " << len << ": " << secrets.size() << " games, avg guesses " << (double)sum_guesses / secrets.size();
+            std::cout << ", failures " << failures << ", time " << time << " ms, " << secrets.size() / time * 1000 << " games/s\n";
+            std::cout << "guesses:";
+            for (int g = 1; g <= max_guesses; g++)
+            {
+                if (distribution[g] > 0)
+                    std::cout << " " << g << ":" << distribution[g];
+            }
+            std::cout << "\nhardest:";
+            for (int k = 0; k < std::min<int>(NUM_HARDEST, order.size()); k++)
+            {
+                int i = order[k];
+                std::cout << " " << secrets[i] << "(" << (found[i] ? std::to_string(guesses[i]) : "x") << ")";
+            }
+            std::cout << "\n\n";
+
+            total_games += secrets.size();
+            total_guesses += sum_guesses;
+            total_failures += failures;
+            total_time += time;
+        }
+        std::cout << "total: " << total_games << " games, avg guesses " << (double)total_guesses / total_games << ", failures " << total_failures;
+        std::cout << ", time " << total_time << " ms, " << total_games / total_time * 1000 << " games/s\n";
+    }
+
     void play_automatic(uint word_length, int max_guesses, int repeats)
     {
         if (!check_word_count(word_length, word_gen))
             return;
 
-        WordleSimulation wordle_sim(words, max_guesses, seed + 1, guesser_strategy);
+        auto configure = [&](BasicRandomWordleGuesser<Graph> &sim_guesser)
+        { configure_guesser(sim_guesser); };
+        // both share the trie and letter counts with the interactive guesser
+        BasicWordleSimulation<WordIndex, Graph> wordle_sim(index, max_guesses, seed + 1, guesser_strategy);
+        BasicParallelWordleSimulation<WordIndex, Graph> parallel_sim(index, max_guesses, seed + 1, guesser_strategy, std::max(1, simulation_threads));
+        configure(wordle_sim.guesser);
+        parallel_sim.configure_guessers(configure);
         auto word_sample = word_gen.n_random_words_of_len(repeats, word_length);
         auto run = [&]()
         {
+            if (simulation_threads > 0)
+            {
+                parallel_sim.play(word_sample);
+                return;
+            }
             for (int i = 0; i < repeats; i++)
             {
-                wordle_sim.play_one_round<false>(word_sample[i]);
+                wordle_sim.template play_one_round<false>(word_sample[i]);
             }
         };
         double avg_time = (double)measureTimeMicroS(run) / repeats;
-        auto [guesses, visited, candidates] = wordle_sim.get_log_data();
+        auto [guesses, visited, candidates, guess_time] = simulation_threads > 0 ? parallel_sim.get_log_data() : wordle_sim.get_log_data();
         double avg_guesses = mean(guesses);
         auto avg_visited = component_wise_mean(visited);
         auto avg_candidates = component_wise_mean(candidates);
+        auto avg_guess_time = component_wise_mean(guess_time);
         std::string unit = "microseconds";
         std::cout << "avg time per game: " << avg_time << " " << unit << "\n";
         std::cout << "avg_guesses      : " << avg_guesses << "\n";
@@ -298,17 +492,115 @@ struct WordleApplication
         print_vector(avg_visited);
         std::cout << "avg candidates   :\n";
         print_vector(avg_candidates);
+        std::cout << "avg time per guess [ns]:\n";
+        print_vector(avg_guess_time);
         std::cout << "\n";
     }
 
+    void print_startup_report()
+    {
+        index->print_phase_times();
+    }
+
     int seed;
     WordList &words;
-    Wordle wordle;
+    BasicWordle<WordIndex> wordle;
     RandomWordGenerator word_gen;
-    RandomWordleGuesser guesser;
+    std::shared_ptr<BasicWordleIndex<Graph>> index;
+    BasicRandomWordleGuesser<Graph> guesser;
     GuesserStrategy guesser_strategy;
+    CandidateEngine candidate_engine = CandidateEngine::TRIE_SEARCH;
+    std::string decision_tree_dir;
+    std::shared_ptr<const OpeningBook> opening_book;
+    // 0 plays the automatic games one after another with one guesser, otherwise each game has its
+    // own guesser seed and the games are split over this many threads
+    int simulation_threads = 0;
+    // ranks the suggestions in play_as_guesser, all words weigh the same if empty
+    std::vector<float> word_weights;
+    std::unique_ptr<FuzzySearch> fuzzy_search;
 };
 
+template <TraversableTrieGraph Graph>
+struct BasicPatternApplication
+{
+    BasicPatternApplication(WordList &_words, int seed) : words(_words), pattern_search(words), word_gen(words, seed), gen(seed) {}
+
+    // patterns from random words where each letter is kept with probability 1/3
+    void play_auto_mode(int repeats, int word_length)
+    {
+        if (!check_word_count(word_length, word_gen))
+            return;
+
+        std::vector<PatternQuery> queries(repeats);
+        for (auto &query : queries)
+        {
+            std::string pattern = word_gen.random_word_of_length(word_length);
+            for (auto &c : pattern)
+            {
+                if (gen.random_index(3) != 0)
+                    c = '.';
+            }
+            query.parse(pattern);
+        }
+
+        std::vector<int> match_cnt;
+        std::vector<int> visited_nodes;
+        match_cnt.reserve(repeats);
+        visited_nodes.reserve(repeats);
+        auto run = [&]()
+        {
+            for (auto &query : queries)
+            {
+                match_cnt.push_back(pattern_search.search(query).size());
+                visited_nodes.push_back(pattern_search.get_num_visited_nodes());
+            }
+        };
+        double avg_time = (double)measureTimeMicroS(run) / repeats;
+        std::cout << "average CPU time per pattern   : " << avg_time << " microseconds\n";
+        std::cout << "average matching words         : " << mean(match_cnt) << "\n";
+        std::cout << "average nodes visited          : " << mean(visited_nodes) << "\n";
+    }
+
+    void play_interactive()
+    {
+        std::stringstream ss;
+        ss << "Type a pattern like c?t*, [aeiou]..e. or ..... -s +r\n";
+        ss << "    . or ?  - any letter,\n";
+        ss << "    *       - any number of letters,\n";
+        ss << "    [abc]   - one of the letters, [^abc] - none of them, [a-e] - a range,\n";
+        ss << "    +abc    - the word contains these letters, -abc - it does not.\n\n";
+        color_print(ss, YELLOW);
+
+        PatternQuery query;
+        while (true)
+        {
+            std::string input = io::get_user_input();
+            if (!std::cin)
+                return;
+            if (!query.parse(input))
+            {
+                std::cout << input << " is not a valid pattern: " << query.error << "\n";
+                continue;
+            }
+            auto indices = pattern_search.search(query);
+            std::cout << "\n";
+            print_indexed_words(indices, words);
+            std::cout << "\n"
+                      << "--> found " << indices.size() << " words"
+                      << "\n\n";
+        }
+    }
+
+    WordList &words;
+    BasicPatternSearch<Graph> pattern_search;
+    RandomWordGenerator word_gen;
+    RandomGenerator gen;
+};
+
+using WordChallengeApplication = BasicWordChallengeApplication<AdjacencyArray<TrieEdge>>;
+using WordleApplication = BasicWordleApplication<Trie, AdjacencyArray<TrieEdge>>;
+using PatternApplication = BasicPatternApplication<AdjacencyArray<CompressedTrieEdge>>;
+
 void wordle_experiment()
 {
     std::string file_small = "../dictionary_9030.txt";
@@ -318,11 +610,14 @@ void wordle_experiment()
 
     GuesserStrategy strategy_random = GuesserStrategy::RANDOM_CANDITATE;
     GuesserStrategy strategy_frequency = GuesserStrategy::LETTER_FREQUENCY;
+    GuesserStrategy strategy_entropy = GuesserStrategy::ENTROPY;
 
     bool print_csv = true;
     bool print_header = true;
     benchmark_wordle(words_small, strategy_random, print_header, print_csv);
     benchmark_wordle(words_small, strategy_frequency, !print_header, print_csv);
+    benchmark_wordle(words_small, strategy_entropy, !print_header, print_csv);
     benchmark_wordle(words_large, strategy_random, !print_header, print_csv);
     benchmark_wordle(words_large, strategy_frequency, !print_header, print_csv);
+    benchmark_wordle(words_large, strategy_entropy, !print_header, print_csv);
 }
\ No newline at end of file
@@ -0,0 +1,65 @@
+#pragma once
+
+#include <vector>
+#include <memory>
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+
+// bump allocator, memory is handed out from large chunks and only released all at once
+struct Arena
+{
+    Arena(size_t _chunk_size = 1 << 20) : chunk_size(_chunk_size) {}
+
+    Arena(const Arena &) = delete;
+    Arena &operator=(const Arena &) = delete;
+
+    void *allocate(size_t bytes, size_t alignment = alignof(std::max_align_t))
+    {
+        num_allocations++;
+        bytes_allocated += bytes;
+        size_t start = (offset + alignment - 1) & ~(alignment - 1);
+        if (chunks.empty() || start + bytes > current_chunk_size)
+        {
+            // oversized requests get their own chunk
+            new_chunk(std::max(bytes + alignment, chunk_size));
+            start = (offset + alignment - 1) & ~(alignment - 1);
+        }
+        offset = start + bytes;
+        return chunks.back().get() + start;
+    }
+
+    template <typename T>
+    T *allocate_array(size_t n)
+    {
+        return static_cast<T *>(allocate(n * sizeof(T), alignof(T)));
+    }
+
+    void release()
+    {
+        chunks.clear();
+        offset = 0;
+        current_chunk_size = 0;
+        bytes_reserved = 0;
+    }
+
+    void new_chunk(size_t size)
+    {
+        // chunk memory is aligned for any fundamental type by new[]
+        chunks.emplace_back(new std::byte[size]);
+        current_chunk_size = size;
+        bytes_reserved += size;
+        offset = 0;
+    }
+
+    int num_chunk_allocations() const { return chunks.size(); }
+
+    std::vector<std::unique_ptr<std::byte[]>> chunks;
+    size_t chunk_size;
+    size_t current_chunk_size = 0;
+    size_t offset = 0;
+
+    size_t num_allocations = 0;
+    size_t bytes_allocated = 0;
+    size_t bytes_reserved = 0;
+};
@@ -5,6 +5,7 @@
 #include <vector>
 #include <string>
 #include <numeric>
+#include <memory>
 
 #include "common.h"
 #include "trie.h"
@@ -16,6 +17,15 @@
 #include "static_trie.h"
 #include "word_challenge.h"
 #include "wordle.h"
+#include "allocator.h"
+#include "bloom_filter.h"
+#include "perfect_hash.h"
+#include "perf_counter.h"
+#include "prefix_completer.h"
+#include "fuzzy_search.h"
+#include "fm_index.h"
+#include "pattern_search.h"
+#include "feedback.h"
 
 template <typename TrieType>
 void benchmark_trie_by_word_length(WordList &words, std::string trie_name)
@@ -51,6 +61,90 @@ void benchmark_trie_by_word_length(WordList &words, std::string trie_name)
         }
         indices.clear();
     }
+    if constexpr (requires { trie.memory_bytes(); })
+    {
+        std::cout << "bytes per word: " << (double)trie.memory_bytes() / words.size() << "\n";
+    }
+    std::cout << checksum << "\n";
+    std::cout << "\n";
+}
+
+template <typename TrieType>
+void benchmark_trie_construction(WordList &words, std::string trie_name)
+{
+    int time_build = 0;
+    int time_extract = 0;
+    size_t allocations = 0;
+    size_t bytes = 0;
+    int num_nodes = 0;
+    {
+        std::unique_ptr<TrieType> trie;
+        time_build = measureTimeMs([&]()
+                                   { trie = std::make_unique<TrieType>(words); });
+        allocations = trie->num_allocations();
+        bytes = trie->memory_bytes();
+        num_nodes = trie->get_num_nodes();
+        time_extract = measureTimeMs([&]()
+                                     { auto graph = trie->template extract_graph<TrieEdge>(); });
+    }
+    std::cout << trie_name << " " << num_nodes << " " << time_build << " " << time_extract << " " << allocations << " " << bytes / (1024 * 1024) << "\n";
+}
+
+void benchmark_trie_construction(WordList &words)
+{
+    std::cout << "trie nodes build[ms] extract_graph[ms] allocations memory[MB]\n";
+    benchmark_trie_construction<Trie>(words, "Trie");
+    benchmark_trie_construction<TrieArena>(words, "TrieArena");
+    benchmark_trie_construction<TrieArray>(words, "TrieArray");
+    benchmark_trie_construction<TrieArrayArena>(words, "TrieArrayArena");
+    std::cout << "\n";
+}
+
+// scalar contains_word loop against the interleaved contains_words batch lookup
+template <typename TrieType>
+void benchmark_batched_lookup_by_word_length(WordList &words, std::string trie_name)
+{
+    std::cout << trie_name << " batched lookup\n";
+
+    uint repeats = 10000;
+    uint seed = 0;
+    uint min_len = 3;
+    uint min_words = 100;
+    uint checksum = 0;
+
+    RandomGenerator gen(seed);
+    TrieType trie(words);
+    std::vector<std::vector<int>> index_len = compute_index_word_of_len(words);
+    std::vector<bool> result;
+
+    std::cout << "length scalar[us] batched[us]\n";
+    for (uint len = min_len; len < index_len.size(); len++)
+    {
+        if (index_len[len].size() < min_words)
+            continue;
+        auto indices = gen.n_random_elements(repeats, index_len[len]);
+        std::vector<std::string_view> queries;
+        queries.reserve(repeats);
+        for (auto i : indices)
+        {
+            queries.push_back(words[i]);
+        }
+        auto scalar = [&]()
+        {
+            for (auto i : indices)
+            {
+                checksum ^= trie.contains_word(words[i]);
+            }
+        };
+        auto batched = [&]()
+        {
+            trie.contains_words(queries, result);
+            checksum ^= std::count(result.begin(), result.end(), true);
+        };
+        double time_scalar = (double)measureTimeMicroS(scalar) / repeats;
+        double time_batched = (double)measureTimeMicroS(batched) / repeats;
+        std::cout << len << " " << time_scalar << " " << time_batched << "\n";
+    }
     std::cout << checksum << "\n";
     std::cout << "\n";
 }
@@ -95,7 +189,7 @@ void benchmark_word_challenge(WordList &words)
     }
 }
 
-void benchmark_wordle(WordList &words, GuesserStrategy strategy, bool print_header = false, bool print_csv = false)
+void benchmark_wordle(WordList &words, GuesserStrategy strategy, bool print_header = false, bool print_csv = false, CandidateEngine engine = CandidateEngine::TRIE_SEARCH, std::shared_ptr<const OpeningBook> opening_book = nullptr)
 {
     int repeats = 100;
     int max_guesses = 20;
@@ -104,6 +198,9 @@ void benchmark_wordle(WordList &words, GuesserStrategy strategy, bool print_head
     int max_len = 20;
     int failed_guesses = 0;
     WordleSimulation sim(words, max_guesses, seed, strategy);
+    sim.guesser.use_candidate_engine(engine);
+    sim.guesser.opening_book = opening_book;
+    sim.guesser.prepare_index();
     RandomWordGenerator word_gen(words, seed);
 
     std::string strategy_name = strategy_to_string(strategy);
@@ -117,6 +214,8 @@ void benchmark_wordle(WordList &words, GuesserStrategy strategy, bool print_head
     {
         std::cout << "benchmark wordle \n";
         std::cout << "strategy: " << strategy_name << "\n";
+        std::cout << "candidate engine: " << candidate_engine_to_string(engine) << "\n";
+        std::cout << "opening book: " << (opening_book != nullptr ? "yes" : "no") << "\n";
     }
 
     for (int len = min_len; len <= max_len; len++)
@@ -134,9 +233,11 @@ void benchmark_wordle(WordList &words, GuesserStrategy strategy, bool print_head
                 // sim.play_one_round<true>(word_sample[i]);
             }
         };
-        double avg_time = (double)measureTimeMs(run) / repeats;
-        auto [guesses, visited, canditates] = sim.get_log_data();
+        auto time = measureTimeMicroS(run);
+        double avg_time = (double)time / 1000 / repeats;
+        auto [guesses, visited, canditates, guess_time] = sim.get_log_data();
         double avg_guesses = mean(guesses);
+        double time_per_guess = (double)time / std::accumulate(guesses.begin(), guesses.end(), 0);
         auto avg_visited = component_wise_mean(visited);
         auto avg_canditates = component_wise_mean(canditates);
         sim.reset_logging();
@@ -159,6 +260,7 @@ void benchmark_wordle(WordList &words, GuesserStrategy strategy, bool print_head
             std::string unit = "ms";
             std::cout << "length: " << len << "\n";
             std::cout << "avg time per game: " << avg_time << " " << unit << "\n";
+            std::cout << "avg time per guess: " << time_per_guess << " us\n";
             std::cout << "avg_guesses: " << avg_guesses << "\n";
             std::cout << "failed guesses: " << failed_guesses << "\n";
 
@@ -166,9 +268,764 @@ void benchmark_wordle(WordList &words, GuesserStrategy strategy, bool print_head
             print_vector(avg_visited);
             std::cout << "canditates ";
             print_vector(avg_canditates);
+            std::cout << "time per guess[ns] ";
+            auto avg_guess_time = component_wise_mean(guess_time);
+            print_vector(avg_guess_time);
 
             std::cout << "\n";
             std::cout << "\n";
         }
     }
-}
\ No newline at end of file
+}
+
+// many games of short words, where a game costs a few microseconds and the per game bookkeeping
+// of the guesser, like forgetting the guessed words, is a visible part of it
+void benchmark_short_wordle_games(WordList &words, int games = 20000)
+{
+    int max_guesses = 20;
+    int seed = 123;
+    RandomWordGenerator word_gen(words, seed);
+
+    std::cout << "benchmark short wordle games \n";
+    std::cout << "strategy word_length games time[ms] ns_per_game avg_guesses\n";
+    for (auto strategy : {GuesserStrategy::RANDOM_CANDITATE, GuesserStrategy::LETTER_FREQUENCY})
+    {
+        for (int len : {3, 4})
+        {
+            if (word_gen.count_words_of_len(len) == 0)
+                continue;
+            WordleSimulation sim(words, max_guesses, seed, strategy);
+            auto secrets = word_gen.n_random_words_of_len(games, len);
+            // builds the lazy state of the length
+            sim.play_one_round<false>(secrets[0]);
+            sim.reset_logging();
+            double time = measureTimeMicroS([&]()
+                                            {
+                for (auto &secret : secrets)
+                {
+                    sim.play_one_round<false>(secret);
+                } }) / 1000.0;
+            auto [guesses, visited, canditates, guess_time] = sim.get_log_data();
+            std::cout << strategy_to_string(strategy) << " " << len << " " << games << " " << time << " " << time * 1e6 / games << " " << mean(guesses) << "\n";
+        }
+    }
+    std::cout << "\n";
+}
+
+// plays the same games with 1, 2, 4, ... threads up to the hardware threads, every run has to log
+// the same guesses, visited nodes and candidates as the single thread run
+void benchmark_parallel_wordle(WordList &words, GuesserStrategy strategy, int len = 5, int repeats = 2000)
+{
+    int max_guesses = 20;
+    int seed = 123;
+    RandomWordGenerator word_gen(words, seed);
+    auto secrets = word_gen.n_random_words_of_len(repeats, len);
+    auto index = std::make_shared<WordleIndex>(words);
+
+    std::cout << "benchmark parallel wordle \n";
+    std::cout << "strategy: " << strategy_to_string(strategy) << "\n";
+    std::cout << "threads time[ms] games_per_s speedup avg_guesses same_as_1_thread\n";
+    std::vector<int> threads = {1};
+    while (threads.back() * 2 <= default_num_threads())
+    {
+        threads.push_back(threads.back() * 2);
+    }
+    if (threads.back() != default_num_threads())
+    {
+        threads.push_back(default_num_threads());
+    }
+    double base_time = 0;
+    std::vector<int> base_guesses;
+    std::vector<std::vector<int>> base_visited, base_canditates;
+    for (int t : threads)
+    {
+        ParallelWordleSimulation sim(index, max_guesses, seed, strategy, t);
+        // first round builds the simulations and the lazy guesser state
+        sim.play(secrets);
+        sim.reset_logging();
+        double time = measureTimeMicroS([&]()
+                                        { sim.play(secrets); }) / 1000.0;
+        auto [guesses, visited, canditates, guess_time] = sim.get_log_data();
+        if (t == 1)
+        {
+            base_time = time;
+            base_guesses = guesses;
+            base_visited = visited;
+            base_canditates = canditates;
+        }
+        bool same = guesses == base_guesses && visited == base_visited && canditates == base_canditates;
+        std::cout << t << " " << time << " " << repeats / time * 1000 << " " << base_time / time << " " << mean(guesses) << " " << (same ? "yes" : "no") << "\n";
+    }
+    std::cout << "\n";
+}
+
+// replays the queries on the dfs ordered graph while recording node visits, stores the profiled
+// node order in order_file and replays the same queries on the graph rebuilt from that file
+template <TraversableTrieGraph Graph = AdjacencyArray<TrieEdge>>
+void benchmark_profile_guided_word_challenge(WordList &words, WordList &queries, std::string order_file)
+{
+    int repeats = 10;
+    CharCounter counter;
+    uint checksum = 0;
+    auto run_queries = [&](BasicWordChallenge<Graph> &wc)
+    {
+        return [&]()
+        {
+            for (int r = 0; r < repeats; r++)
+            {
+                for (auto &q : queries)
+                {
+                    counter.new_counter(q);
+                    checksum ^= wc.possible_words(counter).size();
+                }
+            }
+        };
+    };
+
+    BasicWordChallenge<Graph> wc_dfs(words);
+    wc_dfs.start_recording_visits();
+    int time_record = measureTimeMicroS(run_queries(wc_dfs));
+    wc_dfs.stop_recording_visits();
+    auto order = wc_dfs.compute_profiled_node_order(words);
+    io::write_node_order(order_file, order);
+
+    auto loaded_order = io::read_node_order(order_file);
+    BasicWordChallenge<Graph> wc_profiled(words, loaded_order);
+
+    int time_dfs = measureTimeMicroS(run_queries(wc_dfs));
+    int time_profiled = measureTimeMicroS(run_queries(wc_profiled));
+
+    int hot_nodes = std::count_if(wc_dfs.node_visits.begin(), wc_dfs.node_visits.end(), [](uint32_t c)
+                                  { return c > 0; });
+    double num_queries = (double)repeats * queries.size();
+    std::cout << "profile guided node order (word challenge)\n";
+    std::cout << "queries                  : " << queries.size() << "\n";
+    std::cout << "hot nodes                : " << hot_nodes << " / " << wc_dfs.graph.num_nodes() << "\n";
+    std::cout << "recording [us/query]     : " << time_record / num_queries << "\n";
+    std::cout << "dfs order [us/query]     : " << time_dfs / num_queries << "\n";
+    std::cout << "profiled order [us/query]: " << time_profiled / num_queries << "\n";
+    std::cout << "node order written to " << order_file << "\n";
+    std::cout << checksum << "\n\n";
+}
+
+// same as above for wordle, the secret words form the workload
+template <MembershipIndex WordIndex = Trie, TraversableTrieGraph Graph = AdjacencyArray<TrieEdge>>
+void benchmark_profile_guided_wordle(WordList &words, GuesserStrategy strategy, WordList &secrets, std::string order_file)
+{
+    int max_guesses = 20;
+    int seed = 123;
+    using Simulation = BasicWordleSimulation<WordIndex, Graph>;
+    auto run_games = [&](Simulation &sim)
+    {
+        return [&]()
+        {
+            for (auto &s : secrets)
+            {
+                sim.template play_one_round<false>(s);
+            }
+        };
+    };
+
+    Simulation sim_record(words, max_guesses, seed, strategy);
+    sim_record.guesser.start_recording_visits();
+    run_games(sim_record)();
+    sim_record.guesser.stop_recording_visits();
+    auto order = sim_record.guesser.compute_profiled_node_order();
+    io::write_node_order(order_file, order);
+
+    auto loaded_order = io::read_node_order(order_file);
+    Simulation sim_dfs(words, max_guesses, seed, strategy);
+    Simulation sim_profiled(words, max_guesses, seed, strategy, loaded_order);
+    // both graphs are built before the games are timed
+    sim_dfs.guesser.prepare_index();
+    sim_profiled.guesser.prepare_index();
+    int time_dfs = measureTimeMicroS(run_games(sim_dfs));
+    int time_profiled = measureTimeMicroS(run_games(sim_profiled));
+
+    double num_games = secrets.size();
+    std::cout << "profile guided node order (wordle, " << strategy_to_string(strategy) << ")\n";
+    std::cout << "games                    : " << secrets.size() << "\n";
+    std::cout << "dfs order [us/game]      : " << time_dfs / num_games << "\n";
+    std::cout << "profiled order [us/game] : " << time_profiled / num_games << "\n";
+    std::cout << "node order written to " << order_file << "\n\n";
+}
+
+// latency and dTLB load misses of word challenge and wordle for each allocation policy of the static graph
+void benchmark_memory_policy(WordList &words)
+{
+    int repeats = 1000;
+    int games = 100;
+    int seed = 0;
+    int max_guesses = 20;
+    uint checksum = 0;
+    std::vector<MemoryPolicy> policies = {MemoryPolicy::DEFAULT_ALLOCATION, MemoryPolicy::CACHE_LINE_ALIGNED, MemoryPolicy::HUGE_PAGES};
+
+    std::ifstream thp_file("/sys/kernel/mm/transparent_hugepage/enabled");
+    std::string thp_setting = "unavailable";
+    std::getline(thp_file, thp_setting);
+    std::cout << "transparent huge pages: " << thp_setting << "\n";
+
+    RandomWordGenerator gen_word(words, seed);
+    auto racks = gen_word.n_random_words(repeats);
+    auto secrets = gen_word.n_random_words_of_len(games, 8);
+    CharCounter counter;
+
+    std::string header = "policy wc_time[us] wc_dtlb_misses wordle_time[us] wordle_dtlb_misses";
+    std::cout << header << "\n";
+    for (auto policy : policies)
+    {
+        WordChallenge wc(words, true, policy);
+        WordleSimulation sim(words, max_guesses, seed, GuesserStrategy::RANDOM_CANDITATE, {}, policy);
+        sim.guesser.prepare_index();
+        PerfCounter tlb_misses = PerfCounter::dtlb_load_misses();
+
+        auto run_wc = [&]()
+        {
+            for (auto &rack : racks)
+            {
+                counter.new_counter(rack);
+                checksum ^= wc.possible_words(counter).size();
+            }
+        };
+        auto run_wordle = [&]()
+        {
+            for (auto &secret : secrets)
+            {
+                sim.play_one_round<false>(secret);
+            }
+        };
+
+        tlb_misses.start();
+        double time_wc = (double)measureTimeMicroS(run_wc) / repeats;
+        uint64_t misses_wc = tlb_misses.stop() / repeats;
+        tlb_misses.start();
+        double time_wordle = (double)measureTimeMicroS(run_wordle) / games;
+        uint64_t misses_wordle = tlb_misses.stop() / games;
+
+        std::cout << memory_policy_to_string(policy) << " " << time_wc << " ";
+        std::cout << (tlb_misses.available() ? std::to_string(misses_wc) : "n/a") << " ";
+        std::cout << time_wordle << " ";
+        std::cout << (tlb_misses.available() ? std::to_string(misses_wordle) : "n/a") << "\n";
+    }
+    std::cout << "huge page bytes explicit: " << huge_page_stats.explicit_bytes.load();
+    std::cout << " transparent: " << huge_page_stats.transparent_bytes.load();
+    std::cout << " fallback: " << huge_page_stats.fallback_bytes.load() << "\n";
+    std::cout << checksum << "\n\n";
+}
+
+// compares the sequential dfs ordered graph construction with the parallel one for growing number of threads
+void benchmark_parallel_construction(WordList &words)
+{
+    int time_sequential = measureTimeMs([&]()
+                                        {
+        TrieArena trie(words);
+        AdjacencyList<TrieEdge> adj_list = trie.extract_graph<TrieEdge>();
+        trie.release();
+        auto graph = AdjacencyArray<TrieEdge>::construct_with_dfs_order(adj_list); });
+
+    std::cout << "threads time[ms] speedup\n";
+    std::cout << "sequential " << time_sequential << " 1\n";
+    int max_threads = std::max(8, default_num_threads());
+    for (int threads = 1; threads <= max_threads; threads *= 2)
+    {
+        int time = measureTimeMs([&]()
+                                 { auto graph = build_dfs_trie_graph_parallel<TrieEdge>(words, threads); });
+        std::cout << threads << " " << time << " " << (double)time_sequential / std::max(time, 1) << "\n";
+    }
+    std::cout << "\n";
+}
+
+// word validity checks on streams with a growing share of random strings that are no words
+void benchmark_bloom_filter(WordList &words)
+{
+    int repeats = 100000;
+    int seed = 0;
+    uint checksum = 0;
+    std::vector<double> rates = {0.1, 0.01, 0.001};
+    std::vector<double> negative_shares = {0, 0.5, 0.9, 0.99};
+
+    RandomWordGenerator word_gen(words, seed);
+    RandomGenerator gen(seed);
+    auto random_string = [&](int len)
+    {
+        std::string s(len, 'a');
+        for (auto &c : s)
+        {
+            c = 'a' + gen.random_index(26);
+        }
+        return s;
+    };
+
+    Wordle wordle(words);
+    std::cout << "fpr memory[KB] hashes measured_fpr";
+    for (auto share : negative_shares)
+    {
+        std::cout << " time_" << share << "[ns]";
+    }
+    std::cout << "\n";
+
+    for (double rate : rates)
+    {
+        // same trie for both, so that only the filter makes the difference
+        BlockedBloomFilter filter(words, rate);
+        int false_positives = 0;
+        int negatives = 0;
+        std::vector<double> times_trie;
+        std::vector<double> times_filter;
+        for (auto share : negative_shares)
+        {
+            WordList stream;
+            stream.reserve(repeats);
+            for (int i = 0; i < repeats; i++)
+            {
+                std::string w = word_gen.random_word();
+                if (gen.random_index(1000) < share * 1000)
+                {
+                    w = random_string(w.size());
+                }
+                stream.push_back(w);
+            }
+            auto run_trie = [&]()
+            {
+                for (auto &s : stream)
+                {
+                    checksum ^= wordle.is_valid_word(s);
+                }
+            };
+            auto run_filter = [&]()
+            {
+                for (auto &s : stream)
+                {
+                    checksum ^= filter.may_contain(s) && wordle.is_valid_word(s);
+                }
+            };
+            times_trie.push_back(measureTimeMicroS(run_trie) * 1000.0 / repeats);
+            times_filter.push_back(measureTimeMicroS(run_filter) * 1000.0 / repeats);
+            for (auto &s : stream)
+            {
+                if (!wordle.is_valid_word(s))
+                {
+                    negatives++;
+                    false_positives += filter.may_contain(s);
+                }
+            }
+        }
+        std::cout << rate << " " << filter.memory_bytes() / 1024 << " " << filter.num_hashes << " ";
+        std::cout << (double)false_positives / std::max(negatives, 1);
+        for (auto t : times_filter)
+        {
+            std::cout << " " << t;
+        }
+        std::cout << "\n";
+        if (rate == rates.back())
+        {
+            std::cout << "trie only - - -";
+            for (auto t : times_trie)
+            {
+                std::cout << " " << t;
+            }
+            std::cout << "\n";
+        }
+    }
+    std::cout << checksum << "\n\n";
+}
+
+// top-k completion time per prefix length on growing parts of the dictionary, should not depend on its size
+void benchmark_prefix_completion(WordList &words)
+{
+    int repeats = 100000;
+    int k = 10;
+    int seed = 0;
+    uint checksum = 0;
+    int max_prefix_length = 5;
+    std::vector<int> parts = {8, 4, 2, 1};
+
+    std::cout << "words";
+    for (int len = 1; len <= max_prefix_length; len++)
+    {
+        std::cout << " prefix_" << len << "[ns] visited_" << len;
+    }
+    std::cout << "\n";
+
+    for (int part : parts)
+    {
+        WordList subset;
+        for (uint i = 0; i < words.size(); i += part)
+        {
+            subset.push_back(words[i]);
+        }
+        RandomGenerator gen(seed);
+        std::vector<float> weights(subset.size());
+        for (auto &w : weights)
+        {
+            w = gen.random_index(1000000);
+        }
+        PrefixCompleter completer(subset, std::move(weights));
+
+        std::cout << subset.size();
+        for (int len = 1; len <= max_prefix_length; len++)
+        {
+            WordList prefixes;
+            while ((int)prefixes.size() < repeats)
+            {
+                std::string w = gen.random_element(subset);
+                if ((int)w.size() >= len)
+                {
+                    prefixes.push_back(w.substr(0, len));
+                }
+            }
+            long long visited = 0;
+            auto run = [&]()
+            {
+                for (auto &p : prefixes)
+                {
+                    checksum += completer.complete(p, k).size();
+                    visited += completer.get_num_visited_nodes();
+                }
+            };
+            std::cout << " " << measureTimeMicroS(run) * 1000.0 / repeats << " " << (double)visited / repeats;
+        }
+        std::cout << "\n";
+    }
+    std::cout << checksum << "\n\n";
+}
+
+// bounded edit distance search in the trie against computing the distance to every word
+void benchmark_fuzzy_search(WordList &words)
+{
+    int repeats = 1000;
+    int naive_repeats = 20;
+    int seed = 0;
+    uint checksum = 0;
+
+    RandomWordGenerator word_gen(words, seed);
+    RandomGenerator gen(seed);
+    // dictionary words with one random substitution, so most queries are no words
+    WordList queries = word_gen.n_random_words(repeats);
+    for (auto &q : queries)
+    {
+        q[gen.random_index(q.size())] = 'a' + gen.random_index(26);
+    }
+
+    FuzzySearch fuzzy(words);
+    std::cout << "max_distance trie[us] naive[us] matches visited_nodes\n";
+    for (int k = 1; k <= 2; k++)
+    {
+        long long matches = 0;
+        long long visited = 0;
+        auto run_trie = [&]()
+        {
+            for (auto &q : queries)
+            {
+                matches += fuzzy.search(q, k).size();
+                visited += fuzzy.get_num_visited_nodes();
+            }
+        };
+        auto run_naive = [&]()
+        {
+            for (int i = 0; i < naive_repeats; i++)
+            {
+                for (auto &w : words)
+                {
+                    checksum += edit_distance(queries[i], w) <= k;
+                }
+            }
+        };
+        double time_trie = (double)measureTimeMicroS(run_trie) / repeats;
+        double time_naive = (double)measureTimeMicroS(run_naive) / naive_repeats;
+        std::cout << k << " " << time_trie << " " << time_naive << " " << (double)matches / repeats << " " << (double)visited / repeats << "\n";
+    }
+    std::cout << checksum << "\n\n";
+}
+
+// words containing a substring or ending with a suffix, FM-index against a find on every word
+void benchmark_fm_index(WordList &words)
+{
+    int repeats = 1000;
+    int naive_repeats = 20;
+    int seed = 0;
+    uint checksum = 0;
+
+    size_t text_bytes = 0;
+    for (auto &w : words)
+    {
+        text_bytes += w.size() + 1;
+    }
+    FMIndex index(words);
+    std::cout << "text: " << text_bytes / 1024 << " KB, fm index: " << index.memory_bytes() / 1024 << " KB ("
+              << (double)index.memory_bytes() / text_bytes << " bytes per symbol)\n";
+
+    RandomWordGenerator word_gen(words, seed);
+    RandomGenerator gen(seed);
+    std::cout << "query length fm[us] scan[us] matches\n";
+    for (std::string query : {"substring", "suffix"})
+    {
+        bool suffix = query == "suffix";
+        for (int len = 2; len <= 4; len++)
+        {
+            WordList patterns;
+            while ((int)patterns.size() < repeats)
+            {
+                std::string w = word_gen.random_word();
+                if ((int)w.size() >= len)
+                {
+                    int start = suffix ? w.size() - len : gen.random_index(w.size() - len + 1);
+                    patterns.push_back(w.substr(start, len));
+                }
+            }
+            long long matches = 0;
+            auto run_index = [&]()
+            {
+                for (auto &p : patterns)
+                {
+                    matches += suffix ? index.words_ending_with(p).size() : index.words_containing(p).size();
+                }
+            };
+            auto run_scan = [&]()
+            {
+                for (int i = 0; i < naive_repeats; i++)
+                {
+                    for (auto &w : words)
+                    {
+                        checksum += suffix ? w.ends_with(patterns[i]) : w.find(patterns[i]) != std::string::npos;
+                    }
+                }
+            };
+            double time_index = (double)measureTimeMicroS(run_index) / repeats;
+            double time_scan = (double)measureTimeMicroS(run_scan) / naive_repeats;
+            std::cout << query << " " << len << " " << time_index << " " << time_scan << " " << (double)matches / repeats << "\n";
+        }
+    }
+    std::cout << checksum << "\n\n";
+}
+
+// pattern queries by pruned trie traversal against matching every word
+void benchmark_pattern_search(WordList &words)
+{
+    int repeats = 100;
+    uint checksum = 0;
+    std::vector<std::string> patterns = {"c?t*", "[aeiou]..e.", "..... -s +r", "qu*z*", "*ing -e", "*", "*e*", "*[aeiou]", "........ +eee"};
+
+    PatternSearch pattern_search(words);
+    std::cout << "pattern trie[us] scan[us] matches visited_nodes\n";
+    for (auto &pattern : patterns)
+    {
+        PatternQuery query;
+        query.parse(pattern);
+        int matches = 0;
+        auto run_trie = [&]()
+        {
+            for (int i = 0; i < repeats; i++)
+            {
+                matches = pattern_search.search(query).size();
+            }
+        };
+        auto run_scan = [&]()
+        {
+            for (int i = 0; i < repeats; i++)
+            {
+                for (auto &w : words)
+                {
+                    checksum += query.matches(w);
+                }
+            }
+        };
+        double time_trie = (double)measureTimeMicroS(run_trie) / repeats;
+        double time_scan = (double)measureTimeMicroS(run_scan) / repeats;
+        std::cout << "\"" << pattern << "\" " << time_trie << " " << time_scan << " " << matches << " " << pattern_search.get_num_visited_nodes() << "\n";
+    }
+    std::cout << checksum << "\n\n";
+}
+
+// build time and memory of the feedback tables per length, table lookups against get_wordle_hint
+void benchmark_feedback_matrix(WordList &words, std::string cache_dir = ".")
+{
+    int repeats = 1000000;
+    int seed = 0;
+    uint checksum = 0;
+
+    FeedbackMatrix matrix(words);
+    matrix.print_report();
+    std::cout << "\n";
+
+    {
+        FeedbackMatrix write(words, cache_dir);
+        int time_write = measureTimeMs([&]()
+                                       { for (int len = 1; len < (int)write.tables.size(); len++) if (write.has_table(len)) write.table(len); });
+        FeedbackMatrix load(words, cache_dir);
+        int time_load = measureTimeMs([&]()
+                                      { for (int len = 1; len < (int)load.tables.size(); len++) if (load.has_table(len)) load.table(len); });
+        std::cout << "build and write cache: " << time_write << " ms, map cache: " << time_load << " ms\n";
+    }
+
+    std::cout << "length table[ns] get_wordle_hint[ns]\n";
+    RandomGenerator gen(seed);
+    Wordle wordle(words);
+    for (int len = 1; len < (int)matrix.tables.size(); len++)
+    {
+        if (!matrix.has_table(len))
+            continue;
+        auto &index = matrix.words_of_len[len];
+        auto &table = matrix.table(len);
+        // lazy tables only compute the rows of a few blocks
+        int num_guesses = table.lazy ? std::min<int>(index.size(), 16 * FeedbackTable::BLOCK_ROWS) : index.size();
+        std::vector<std::pair<int, int>> pairs(repeats);
+        for (auto &p : pairs)
+        {
+            p = {gen.random_index(num_guesses), gen.random_index(index.size())};
+        }
+        auto run_table = [&]()
+        {
+            for (auto [g, s] : pairs)
+            {
+                checksum += table.code(g, s);
+            }
+        };
+        WordleHint hint(len);
+        auto run_hint = [&]()
+        {
+            for (auto [g, s] : pairs)
+            {
+                wordle.set_secret_word(words[index[s]]);
+                wordle.get_wordle_hint(hint, words[index[g]]);
+                checksum += hint[0];
+            }
+        };
+        double time_table = measureTimeMicroS(run_table) * 1000.0 / repeats;
+        double time_hint = measureTimeMicroS(run_hint) * 1000.0 / repeats;
+        std::cout << len << " " << time_table << " " << time_hint << (table.lazy ? " (lazy, including block construction)" : "") << "\n";
+    }
+    std::cout << checksum << "\n\n";
+}
+
+// feedback of a guess against all words of its length: get_wordle_hint and pattern_code per pair
+// against batch_pattern_codes over the position major words
+void benchmark_feedback_kernel(WordList &words)
+{
+    int num_guesses = 200;
+    int seed = 0;
+    uint checksum = 0;
+    auto words_of_len = compute_index_word_of_len(words);
+    RandomGenerator gen(seed);
+    Wordle wordle(words);
+
+    std::cout << "benchmark feedback kernel\n";
+    std::cout << "length secrets get_wordle_hint[ns] pattern_code[ns] batch[ns]\n";
+    for (int len = 1; len < std::min<int>(words_of_len.size(), MAX_BATCH_LENGTH + 1); len++)
+    {
+        auto &index = words_of_len[len];
+        if (index.empty())
+            continue;
+        SecretBatch batch(words, index);
+        std::vector<uint32_t> codes(batch.stride);
+        auto guesses = gen.n_random_elements(num_guesses, index);
+        WordleHint hint(len);
+        auto run_hint = [&]()
+        {
+            for (int g : guesses)
+            {
+                for (int s : index)
+                {
+                    wordle.set_secret_word(words[s]);
+                    wordle.get_wordle_hint(hint, words[g]);
+                    checksum += hint[0];
+                }
+            }
+        };
+        auto run_scalar = [&]()
+        {
+            for (int g : guesses)
+            {
+                for (int s : index)
+                {
+                    checksum += pattern_code(words[g], words[s]);
+                }
+            }
+        };
+        auto run_batch = [&]()
+        {
+            for (int g : guesses)
+            {
+                batch_pattern_codes(words[g], batch, codes.data());
+                checksum += codes[0];
+            }
+        };
+        double pairs = (double)num_guesses * index.size();
+        double time_hint = measureTimeMicroS(run_hint) * 1000.0 / pairs;
+        double time_scalar = measureTimeMicroS(run_scalar) * 1000.0 / pairs;
+        double time_batch = measureTimeMicroS(run_batch) * 1000.0 / pairs;
+        std::cout << len << " " << index.size() << " " << time_hint << " " << time_scalar << " " << time_batch << "\n";
+    }
+    std::cout << checksum << "\n\n";
+}
+
+// decision trees of every length with a feedback table, replayed for all secrets
+void benchmark_decision_tree(WordList &words, std::string tree_dir = ".")
+{
+    FeedbackMatrix feedback(words);
+    std::cout << "benchmark decision tree\n";
+    std::cout << "length secrets objective build_time[ms] load_time[us] nodes size[KB] max_depth avg_depth replay[ns/guess]\n";
+    for (int len = 1; len <= DecisionTree::MAX_LENGTH; len++)
+    {
+        if (!feedback.has_table(len) || feedback.table(len).lazy)
+            continue;
+        auto &table = feedback.table(len);
+        for (auto objective : {TreeObjective::WORST_CASE, TreeObjective::EXPECTED})
+        {
+            DecisionTree tree;
+            int build_time = measureTimeMs([&]()
+                                           { DecisionTreeSolver solver(table, objective);
+                                             tree = solver.solve(); });
+            std::string path = tree_dir + "/decision_tree_" + std::to_string(len) + ".bin";
+            tree.save(path, table.dictionary_hash());
+            DecisionTree loaded;
+            int load_time = measureTimeMicroS([&]()
+                                              { loaded.load(path, len, objective, table.dictionary_hash(), words); });
+            std::remove(path.c_str());
+
+            // replays every secret, one child lookup per guess
+            long long guesses = 0;
+            auto replay = [&]()
+            {
+                for (int s : table.word_indices)
+                {
+                    int v = 0;
+                    while (v != -1)
+                    {
+                        guesses++;
+                        std::string &guess = words[loaded.nodes[v].guess];
+                        if (guess == words[s])
+                            break;
+                        v = loaded.child(v, pattern_code(guess, words[s]));
+                    }
+                }
+            };
+            double replay_time = measureTimeMicroS(replay) * 1000.0 / guesses;
+            std::cout << len << " " << tree.num_secrets << " " << tree_objective_to_string(objective) << " " << build_time << " " << load_time << " ";
+            std::cout << tree.nodes.size() << " " << tree.memory_bytes() / 1024 << " " << tree.max_depth << " " << tree.avg_depth() << " " << replay_time << "\n";
+        }
+    }
+    std::cout << "\n";
+}
+
+void benchmark_opening_book(WordList &words, std::string path = "opening_book.bin")
+{
+    std::cout << "benchmark opening book\n";
+    auto book = std::make_shared<OpeningBook>();
+    for (int num_threads : {1, default_num_threads()})
+    {
+        OpeningBookBuilder builder(words, num_threads);
+        int time_build = measureTimeMs([&]()
+                                       { *book = builder.build(); });
+        std::cout << "build with " << num_threads << " threads: " << time_build << " ms\n";
+    }
+    book->save(path);
+    OpeningBook loaded;
+    int time_load = measureTimeMicroS([&]()
+                                      { loaded.load(path, words); });
+    std::cout << "size: " << book->memory_bytes() / 1024 << " KB, load: " << time_load << " us\n\n";
+    std::remove(path.c_str());
+
+    benchmark_wordle(words, GuesserStrategy::ENTROPY);
+    benchmark_wordle(words, GuesserStrategy::ENTROPY, false, false, CandidateEngine::TRIE_SEARCH, book);
+}
@@ -0,0 +1,102 @@
+#pragma once
+
+#include <vector>
+#include <string>
+#include <string_view>
+#include <cmath>
+#include <cstdint>
+#include <algorithm>
+
+#include "common.h"
+
+inline uint64_t mix_hash(uint64_t h)
+{
+    // murmur3 finalizer
+    h ^= h >> 33;
+    h *= 0xff51afd7ed558ccdULL;
+    h ^= h >> 33;
+    h *= 0xc4ceb9fe1a85ec53ULL;
+    h ^= h >> 33;
+    return h;
+}
+
+inline uint64_t hash_string(std::string_view s, uint64_t seed = 0)
+{
+    // FNV-1a followed by a finalizer, the raw FNV bits are too weak for bit selection
+    uint64_t h = 0xcbf29ce484222325ULL ^ seed;
+    for (char c : s)
+    {
+        h ^= (unsigned char)c;
+        h *= 0x100000001b3ULL;
+    }
+    return mix_hash(h);
+}
+
+// blocked bloom filter: all bits of a key lie in one 512 bit block, i.e. one cache line,
+// so a negative lookup costs a single cache miss
+struct BlockedBloomFilter
+{
+    static constexpr int BLOCK_BITS = 512;
+
+    struct alignas(64) Block
+    {
+        uint64_t bits[BLOCK_BITS / 64] = {};
+    };
+
+    BlockedBloomFilter() {}
+
+    BlockedBloomFilter(WordList &words, double false_positive_rate)
+    {
+        // optimal parameters of a standard bloom filter, blocking needs about 10% more bits for the same rate
+        double bits_per_key = -std::log(false_positive_rate) / (std::log(2) * std::log(2));
+        num_hashes = std::clamp((int)std::round(bits_per_key * std::log(2)), 1, 16);
+        size_t num_bits = std::max<size_t>(BLOCK_BITS, words.size() * bits_per_key * 1.1);
+        blocks.resize((num_bits + BLOCK_BITS - 1) / BLOCK_BITS);
+        for (auto &s : words)
+        {
+            insert(s);
+        }
+    }
+
+    inline size_t block_index(uint64_t h) const
+    {
+        // multiply shift range reduction instead of modulo
+        return (size_t)(((unsigned __int128)(h >> 32) * blocks.size()) >> 32);
+    }
+
+    void insert(std::string_view s)
+    {
+        uint64_t h = hash_string(s);
+        Block &block = blocks[block_index(h)];
+        uint32_t h1 = h;
+        uint32_t h2 = mix_hash(h) | 1;
+        for (int i = 0; i < num_hashes; i++)
+        {
+            uint32_t bit = (h1 + i * h2) % BLOCK_BITS;
+            block.bits[bit / 64] |= 1ULL << (bit % 64);
+        }
+    }
+
+    // false means that s was never inserted
+    bool may_contain(std::string_view s) const
+    {
+        uint64_t h = hash_string(s);
+        const Block &block = blocks[block_index(h)];
+        uint32_t h1 = h;
+        uint32_t h2 = mix_hash(h) | 1;
+        for (int i = 0; i < num_hashes; i++)
+        {
+            uint32_t bit = (h1 + i * h2) % BLOCK_BITS;
+            if (!(block.bits[bit / 64] & (1ULL << (bit % 64))))
+            {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    size_t memory_bytes() const { return blocks.size() * sizeof(Block); }
+
+    int num_hashes = 0;
+    std::vector<Block> blocks;
+};
@@ -0,0 +1,190 @@
+#pragma once
+
+#include <vector>
+#include <string>
+#include <algorithm>
+#include <numeric>
+#include <bit>
+#include <cstdint>
+#ifdef __AVX2__
+#include <immintrin.h>
+#endif
+
+#include "common.h"
+
+enum CandidateEngine
+{
+    TRIE_SEARCH,
+    BITSET,
+};
+
+std::string candidate_engine_to_string(CandidateEngine engine)
+{
+    if (engine == CandidateEngine::TRIE_SEARCH)
+    {
+        return "trie";
+    }
+    else if (engine == CandidateEngine::BITSET)
+    {
+        return "bitset";
+    }
+    else
+    {
+        return "";
+    }
+}
+
+// bitsets over all words of one length: "letter c at position i" and "at least k copies of c",
+// a wordle hint state becomes a list of AND and ANDNOT operations on them
+//
+// bit j stands for the j-th word in lexicographic order, the order in which the trie search finds
+// candidates; of equal words only the last index is kept, like in node_to_word_index
+struct CandidateBitsets
+{
+    // 4 words per AVX2 register
+    static constexpr int WORDS_PER_STEP = 4;
+
+    struct Operation
+    {
+        const uint64_t *bits;
+        bool negate;
+    };
+
+    CandidateBitsets(WordList &words, std::vector<int> &index)
+    {
+        word_ids = index;
+        std::stable_sort(word_ids.begin(), word_ids.end(), [&](int a, int b)
+                         { return words[a] < words[b]; });
+        // keeps the last of equal words
+        std::vector<int> unique_ids;
+        for (uint i = 0; i < word_ids.size(); i++)
+        {
+            if (i + 1 < word_ids.size() && words[word_ids[i]] == words[word_ids[i + 1]])
+                continue;
+            unique_ids.push_back(word_ids[i]);
+        }
+        word_ids = unique_ids;
+
+        num_words = word_ids.size();
+        length = num_words > 0 ? words[word_ids[0]].size() : 0;
+        num_blocks = (num_words + 64 * WORDS_PER_STEP - 1) / (64 * WORDS_PER_STEP) * WORDS_PER_STEP;
+
+        max_count.assign(26, 0);
+        std::vector<std::vector<int>> counts(num_words, std::vector<int>(26, 0));
+        for (int j = 0; j < num_words; j++)
+        {
+            for (char c : words[word_ids[j]])
+            {
+                counts[j][c - 'a']++;
+            }
+            for (int l = 0; l < 26; l++)
+            {
+                max_count[l] = std::max(max_count[l], counts[j][l]);
+            }
+        }
+        at_least_offset.assign(27, 0);
+        for (int l = 0; l < 26; l++)
+        {
+            at_least_offset[l + 1] = at_least_offset[l] + max_count[l];
+        }
+
+        // position bitsets first, then count bitsets, then the all ones and all zeros bitsets
+        int num_bitsets = length * 26 + at_least_offset[26] + 2;
+        bits.assign((size_t)num_bitsets * num_blocks, 0);
+        for (int j = 0; j < num_words; j++)
+        {
+            uint64_t bit = 1ULL << (j % 64);
+            std::string &w = words[word_ids[j]];
+            for (int i = 0; i < length; i++)
+            {
+                letter_at(i, w[i])[j / 64] |= bit;
+            }
+            for (int l = 0; l < 26; l++)
+            {
+                for (int k = 1; k <= counts[j][l]; k++)
+                {
+                    mutable_at_least(l + 'a', k)[j / 64] |= bit;
+                }
+            }
+            mutable_bitset(num_bitsets - 2)[j / 64] |= bit;
+        }
+    }
+
+    uint64_t *mutable_bitset(int b) { return bits.data() + (size_t)b * num_blocks; }
+    const uint64_t *bitset(int b) const { return bits.data() + (size_t)b * num_blocks; }
+
+    uint64_t *letter_at(int pos, char c) { return mutable_bitset(pos * 26 + c - 'a'); }
+    const uint64_t *letter_at(int pos, char c) const { return bitset(pos * 26 + c - 'a'); }
+
+    uint64_t *mutable_at_least(char c, int k) { return mutable_bitset(length * 26 + at_least_offset[c - 'a'] + k - 1); }
+
+    // words with at least k >= 1 copies of c
+    const uint64_t *at_least(char c, int k) const
+    {
+        if (k > max_count[c - 'a'])
+        {
+            return no_words();
+        }
+        return bitset(length * 26 + at_least_offset[c - 'a'] + k - 1);
+    }
+
+    const uint64_t *all_words() const { return bitset(length * 26 + at_least_offset[26]); }
+    const uint64_t *no_words() const { return bitset(length * 26 + at_least_offset[26] + 1); }
+
+    // word ids of all words in the intersection, in lexicographic order
+    void evaluate(std::vector<Operation> &operations, std::vector<int> &result) const
+    {
+        result.clear();
+        for (int b = 0; b < num_blocks; b += WORDS_PER_STEP)
+        {
+            uint64_t block[WORDS_PER_STEP];
+#ifdef __AVX2__
+            __m256i acc = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(all_words() + b));
+            for (auto &op : operations)
+            {
+                __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(op.bits + b));
+                acc = op.negate ? _mm256_andnot_si256(v, acc) : _mm256_and_si256(acc, v);
+            }
+            if (_mm256_testz_si256(acc, acc))
+            {
+                continue;
+            }
+            _mm256_storeu_si256(reinterpret_cast<__m256i *>(block), acc);
+#else
+            bool any = false;
+            for (int k = 0; k < WORDS_PER_STEP; k++)
+            {
+                uint64_t acc = all_words()[b + k];
+                for (auto &op : operations)
+                {
+                    acc = op.negate ? acc & ~op.bits[b + k] : acc & op.bits[b + k];
+                }
+                block[k] = acc;
+                any |= acc != 0;
+            }
+            if (!any)
+            {
+                continue;
+            }
+#endif
+            for (int k = 0; k < WORDS_PER_STEP; k++)
+            {
+                for (uint64_t w = block[k]; w != 0; w &= w - 1)
+                {
+                    result.push_back(word_ids[(b + k) * 64 + std::countr_zero(w)]);
+                }
+            }
+        }
+    }
+
+    size_t memory_bytes() const { return bits.size() * sizeof(uint64_t) + word_ids.size() * sizeof(int); }
+
+    int length;
+    int num_words;
+    // number of 64 bit words per bitset, multiple of WORDS_PER_STEP
+    int num_blocks;
+    std::vector<int> word_ids;
+    std::vector<int> max_count;
+    std::vector<int> at_least_offset;
+    std::vector<uint64_t> bits;
+};
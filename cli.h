@@ -24,8 +24,20 @@ namespace cli
         std::string game_type;
         std::string game_mode_word_challenge;
         std::string game_mode_wordle;
+        std::string game_mode_pattern;
         std::string wordle_guesser_strategy;
+        std::string candidate_engine;
+        std::string decision_tree_dir;
+        std::string opening_book_file;
+        int simulation_threads;
         std::string dictionary_file;
+        std::string query_log_file;
+        std::string node_order_file;
+        std::string memory_policy;
+        double bloom_filter_fpr;
+        std::string graph_backend;
+        std::string word_index;
+        std::string word_weights_file;
 
         void print()
         {
@@ -40,13 +52,66 @@ namespace cli
             SHOW_ARGUMENT(game_type);
             SHOW_ARGUMENT(game_mode_word_challenge);
             SHOW_ARGUMENT(game_mode_wordle);
+            SHOW_ARGUMENT(game_mode_pattern);
             SHOW_ARGUMENT(wordle_guesser_strategy);
+            SHOW_ARGUMENT(candidate_engine);
+            SHOW_ARGUMENT(decision_tree_dir);
+            SHOW_ARGUMENT(opening_book_file);
+            SHOW_ARGUMENT(simulation_threads);
             SHOW_ARGUMENT(dictionary_file);
+            SHOW_ARGUMENT(query_log_file);
+            SHOW_ARGUMENT(node_order_file);
+            SHOW_ARGUMENT(memory_policy);
+            SHOW_ARGUMENT(bloom_filter_fpr);
+            SHOW_ARGUMENT(graph_backend);
+            SHOW_ARGUMENT(word_index);
+            SHOW_ARGUMENT(word_weights_file);
             std::cout << banner << "\n";
             std::cout << "\n";
         }
     };
 
+    MemoryPolicy parse_memory_policy(std::string &name)
+    {
+        if (name == "aligned")
+        {
+            return MemoryPolicy::CACHE_LINE_ALIGNED;
+        }
+        else if (name == "huge_pages")
+        {
+            return MemoryPolicy::HUGE_PAGES;
+        }
+        return MemoryPolicy::DEFAULT_ALLOCATION;
+    }
+
+    template <TraversableTrieGraph Graph>
+    void run_word_challenge_application(Config &config, WordList &words)
+    {
+        if (!config.query_log_file.empty())
+        {
+            WordList queries = io::read_dictionary(config.query_log_file);
+            benchmark_profile_guided_word_challenge<Graph>(words, queries, config.node_order_file);
+            return;
+        }
+
+        std::vector<int> node_order;
+        if (!config.node_order_file.empty())
+        {
+            node_order = io::read_node_order(config.node_order_file);
+        }
+        MemoryPolicy policy = parse_memory_policy(config.memory_policy);
+        using Application = BasicWordChallengeApplication<Graph>;
+        Application app = node_order.empty() ? Application(words, config.seed, policy) : Application(words, config.seed, node_order, policy);
+        if (config.game_mode_word_challenge == "auto")
+        {
+            app.play_auto_mode(config.repeats, config.word_length);
+        }
+        else
+        {
+            app.play_interactive();
+        }
+    }
+
     void word_challenge_application(Config &config)
     {
         WordList words = io::read_dictionary(config.dictionary_file);
@@ -55,8 +120,25 @@ namespace cli
             return;
         }
 
-        WordChallengeApplication app(words, config.seed);
-        if (config.game_mode_word_challenge == "auto")
+        if (config.graph_backend == "compressed_edge")
+        {
+            run_word_challenge_application<AdjacencyArray<CompressedTrieEdge>>(config, words);
+        }
+        else if (config.graph_backend == "adjacency_list")
+        {
+            run_word_challenge_application<AdjacencyList<TrieEdge>>(config, words);
+        }
+        else
+        {
+            run_word_challenge_application<AdjacencyArray<TrieEdge>>(config, words);
+        }
+    }
+
+    template <TraversableTrieGraph Graph>
+    void run_pattern_application(Config &config, WordList &words)
+    {
+        BasicPatternApplication<Graph> app(words, config.seed);
+        if (config.game_mode_pattern == "auto")
         {
             app.play_auto_mode(config.repeats, config.word_length);
         }
@@ -66,19 +148,96 @@ namespace cli
         }
     }
 
-    void wordle_application(Config &config)
+    void pattern_application(Config &config)
     {
         WordList words = io::read_dictionary(config.dictionary_file);
         if (!io::check_word_list(words))
         {
             return;
         }
+
+        if (config.graph_backend == "trie_edge")
+        {
+            run_pattern_application<AdjacencyArray<TrieEdge>>(config, words);
+        }
+        else if (config.graph_backend == "adjacency_list")
+        {
+            run_pattern_application<AdjacencyList<TrieEdge>>(config, words);
+        }
+        else
+        {
+            run_pattern_application<AdjacencyArray<CompressedTrieEdge>>(config, words);
+        }
+    }
+
+    // builds and stores the book if the file is missing or belongs to another dictionary
+    std::shared_ptr<const OpeningBook> load_opening_book(std::string &path, WordList &words)
+    {
+        auto book = std::make_shared<OpeningBook>();
+        bool loaded = false;
+        int time_load = measureTimeMs([&]()
+                                      { loaded = book->load(path, words); });
+        if (loaded)
+        {
+            std::cout << "opening book: loaded in " << time_load << " ms\n\n";
+            return book;
+        }
+        OpeningBookBuilder builder(words);
+        int time_build = measureTimeMs([&]()
+                                       { *book = builder.build(); });
+        book->save(path);
+        std::cout << "opening book: built in " << time_build << " ms, " << book->memory_bytes() / 1024 << " KB\n\n";
+        return book;
+    }
+
+    template <MembershipIndex WordIndex, TraversableTrieGraph Graph>
+    void run_wordle_application(Config &config, WordList &words)
+    {
         GuesserStrategy guesser_strategy = GuesserStrategy::RANDOM_CANDITATE;
         if (config.wordle_guesser_strategy == "letter_frequency")
         {
             guesser_strategy = GuesserStrategy::LETTER_FREQUENCY;
         }
-        WordleApplication app(words, config.seed, guesser_strategy);
+        else if (config.wordle_guesser_strategy == "entropy")
+        {
+            guesser_strategy = GuesserStrategy::ENTROPY;
+        }
+        else if (config.wordle_guesser_strategy == "decision_tree")
+        {
+            guesser_strategy = GuesserStrategy::DECISION_TREE;
+        }
+        if (!config.query_log_file.empty())
+        {
+            WordList secrets = io::read_dictionary(config.query_log_file);
+            benchmark_profile_guided_wordle<WordIndex, Graph>(words, guesser_strategy, secrets, config.node_order_file);
+            return;
+        }
+
+        std::vector<int> node_order;
+        if (!config.node_order_file.empty())
+        {
+            node_order = io::read_node_order(config.node_order_file);
+        }
+        MemoryPolicy policy = parse_memory_policy(config.memory_policy);
+        BasicWordleApplication<WordIndex, Graph> app(words, config.seed, guesser_strategy, node_order, policy, config.bloom_filter_fpr);
+        if (config.candidate_engine == "bitset")
+        {
+            app.use_candidate_engine(CandidateEngine::BITSET);
+        }
+        app.set_decision_tree_dir(config.decision_tree_dir);
+        app.simulation_threads = config.simulation_threads;
+        if (!config.opening_book_file.empty())
+        {
+            app.set_opening_book(load_opening_book(config.opening_book_file, words));
+        }
+        if (!config.word_weights_file.empty())
+        {
+            app.word_weights = io::read_word_weights(config.word_weights_file, words);
+        }
+        if (app.wordle.use_filter)
+        {
+            std::cout << "bloom filter: " << app.wordle.filter.memory_bytes() << " bytes, " << app.wordle.filter.num_hashes << " hashes\n\n";
+        }
 
         if (config.game_mode_wordle == "guesser")
         {
@@ -88,9 +247,58 @@ namespace cli
         {
             app.play_as_keeper(config.word_length, config.max_guesses);
         }
+        else if (config.game_mode_wordle == "all_secrets")
+        {
+            app.play_all_secrets(config.max_guesses);
+            app.print_startup_report();
+        }
         else
         {
             app.play_automatic(config.word_length, config.max_guesses, config.repeats);
+            app.print_startup_report();
+        }
+    }
+
+    template <MembershipIndex WordIndex>
+    void run_wordle_application(Config &config, WordList &words)
+    {
+        if (config.graph_backend == "compressed_edge")
+        {
+            run_wordle_application<WordIndex, AdjacencyArray<CompressedTrieEdge>>(config, words);
+        }
+        else if (config.graph_backend == "adjacency_list")
+        {
+            run_wordle_application<WordIndex, AdjacencyList<TrieEdge>>(config, words);
+        }
+        else
+        {
+            run_wordle_application<WordIndex, AdjacencyArray<TrieEdge>>(config, words);
+        }
+    }
+
+    void wordle_application(Config &config)
+    {
+        WordList words = io::read_dictionary(config.dictionary_file);
+        if (!io::check_word_list(words))
+        {
+            return;
+        }
+
+        if (config.word_index == "trie_array")
+        {
+            run_wordle_application<TrieArray>(config, words);
+        }
+        else if (config.word_index == "static_trie")
+        {
+            run_wordle_application<StaticTrieGraph<CompressedTrieEdge>>(config, words);
+        }
+        else if (config.word_index == "perfect_hash")
+        {
+            run_wordle_application<PerfectHashWordSet>(config, words);
+        }
+        else
+        {
+            run_wordle_application<Trie>(config, words);
         }
     }
 
@@ -105,30 +313,64 @@ namespace cli
         std::string game_type = "word_challenge";
         std::string game_mode_word_challenge = "auto";
         std::string game_mode_wordle = "auto";
+        std::string game_mode_pattern = "interactive";
         std::string wordle_guesser_strategy = "letter_frequency";
+        std::string candidate_engine = "trie";
+        std::string decision_tree_dir = "";
+        std::string opening_book_file = "";
+        int simulation_threads = 0;
         std::string dictionary_file = "../dictionary_9030.txt";
+        std::string query_log_file = "";
+        std::string node_order_file = "";
+        std::string memory_policy = "default";
+        double bloom_filter_fpr = 0;
+        std::string graph_backend = "trie_edge";
+        std::string word_index = "trie";
+        std::string word_weights_file = "";
         bool run_wordle_experiment = false;
 
-        std::vector<std::string> allowed_game_types = {"word_challenge", "wordle"};
-        std::vector<std::string> allowed_game_mode_wordle = {"auto", "keeper", "guesser"};
+        std::vector<std::string> allowed_game_types = {"word_challenge", "wordle", "pattern"};
+        std::vector<std::string> allowed_game_mode_wordle = {"auto", "keeper", "guesser", "all_secrets"};
         std::vector<std::string> allowed_game_mode_word_challenge = {"auto", "interactive"};
-        std::vector<std::string> allowed_wordle_strategies = {"random_canditate", "letter_frequency"};
+        std::vector<std::string> allowed_game_mode_pattern = {"auto", "interactive"};
+        std::vector<std::string> allowed_wordle_strategies = {"random_canditate", "letter_frequency", "entropy", "decision_tree"};
+        std::vector<std::string> allowed_candidate_engines = {"trie", "bitset"};
+        std::vector<std::string> allowed_memory_policies = {"default", "aligned", "huge_pages"};
+        std::vector<std::string> allowed_graph_backends = {"trie_edge", "compressed_edge", "adjacency_list"};
+        std::vector<std::string> allowed_word_indices = {"trie", "trie_array", "static_trie", "perfect_hash"};
 
         app.add_option("-l, --word_length", word_length, "word length to be used in game")->check(CLI::Range(1, 100));
         app.add_option("-r, --repeats", repeats, "number of times automatic mode repeats game")->check(CLI::Range(1, 1000000000));
         app.add_option("-g, --max_guesses", max_guesses, "maximal number of guess in wordle game")->check(CLI::Range(1, 1000000000));
         app.add_option("-s, --seed", max_guesses, "seed for random number generation");
         app.add_option("-t, --game_type", game_type, "select type of game")->check(CLI::IsMember(allowed_game_types));
-        app.add_option("-w, --game_mode_wordle", game_mode_wordle, "game mode in wordle game")->check(CLI::IsMember(allowed_game_mode_wordle));
+        app.add_option("-w, --game_mode_wordle", game_mode_wordle, "game mode in wordle game, all_secrets plays every word of every length once")->check(CLI::IsMember(allowed_game_mode_wordle));
         app.add_option("-c, --game_mode_word_challenge", game_mode_word_challenge, "game mode in word challenge game")->check(CLI::IsMember(allowed_game_mode_word_challenge));
+        app.add_option("-p, --game_mode_pattern", game_mode_pattern, "game mode in pattern game, auto runs random patterns")->check(CLI::IsMember(allowed_game_mode_pattern));
         app.add_option("--wordle_strategy", wordle_guesser_strategy, "strategy of the guesser in wordle")->check(CLI::IsMember(allowed_wordle_strategies));
+        app.add_option("--decision_tree_dir", decision_tree_dir, "directory of the decision trees of the decision_tree strategy, built and stored there if missing");
+        app.add_option("--opening_book", opening_book_file, "file with the first two guesses of the entropy strategy, built and stored there if missing");
+        app.add_option("--simulation_threads", simulation_threads, "threads of the automatic wordle mode, each game gets a seed of its own so the results do not depend on the count; 0 plays all games on one guesser")->check(CLI::Range(0, 1024));
+        app.add_option("--candidate_engine", candidate_engine, "search of the wordle candidates, trie traversal or bitset intersection")->check(CLI::IsMember(allowed_candidate_engines));
         app.add_option("-f, --file", dictionary_file, "path to dictionary file")->check(CLI::ExistingFile);
-        
+        app.add_option("--query_log", query_log_file, "replay queries (racks or secret words) from file, record node visits and store the profiled node order in --node_order")->check(CLI::ExistingFile);
+        app.add_option("--node_order", node_order_file, "node order file written by --query_log, loaded to rebuild the index otherwise");
+        app.add_option("--memory_policy", memory_policy, "allocation of the static graph and word id arrays")->check(CLI::IsMember(allowed_memory_policies));
+        app.add_option("--bloom_filter_fpr", bloom_filter_fpr, "false positive rate of the bloom filter in front of the word validity check, 0 disables it")->check(CLI::Range(0.0, 0.5));
+        app.add_option("--graph_backend", graph_backend, "trie graph traversed by the word challenge solver and the wordle guesser")->check(CLI::IsMember(allowed_graph_backends));
+        app.add_option("--word_index", word_index, "index for the word validity check in wordle")->check(CLI::IsMember(allowed_word_indices));
+        app.add_option("--word_weights", word_weights_file, "file with lines \"word weight\" that ranks the suggestions in the wordle guesser mode")->check(CLI::ExistingFile);
+
         app.add_flag("-e, --run_wordle_experiment", run_wordle_experiment, "run wordle experiment");
 
         CLI11_PARSE(app, argc, argv);
 
-        Config config{word_length, repeats, max_guesses, seed, game_type, game_mode_word_challenge, game_mode_wordle, wordle_guesser_strategy, dictionary_file};
+        if (!query_log_file.empty() && node_order_file.empty())
+        {
+            node_order_file = "node_order.bin";
+        }
+
+        Config config{word_length, repeats, max_guesses, seed, game_type, game_mode_word_challenge, game_mode_wordle, game_mode_pattern, wordle_guesser_strategy, candidate_engine, decision_tree_dir, opening_book_file, simulation_threads, dictionary_file, query_log_file, node_order_file, memory_policy, bloom_filter_fpr, graph_backend, word_index, word_weights_file};
 
         config.print();
 
@@ -140,6 +382,10 @@ namespace cli
         {
             wordle_application(config);
         }
+        else if (game_type == "pattern")
+        {
+            pattern_application(config);
+        }
         else
         {
             word_challenge_application(config);
@@ -6,6 +6,10 @@
 #include <cassert>
 #include <iostream>
 #include <iomanip>
+#include <thread>
+#include <atomic>
+#include <algorithm>
+#include <type_traits>
 
 #define LOG(x) std::cout << std::string(#x " = ") << (x) << "\n";
 
@@ -69,7 +73,8 @@ double mean(std::vector<int> &v)
 }
 
 // if vector is to short compute the mean of remaining vectors
-std::vector<long long> component_wise_mean(std::vector<std::vector<int>> &v)
+template <typename T>
+std::vector<long long> component_wise_mean(std::vector<std::vector<T>> &v)
 {
     int max_cols = 0;
     for (auto &vec : v)
@@ -207,4 +212,41 @@ struct CharCounter
     }
 
     std::vector<int> counter;
-};
\ No newline at end of file
+};
+
+// calls f(task) or f(task, worker) for every task, worker < num_threads is the thread running the
+// task, the calling thread is worker 0; buffers indexed by worker are reused by all its tasks
+template <typename Function>
+void parallel_for_each(int num_tasks, int num_threads, Function f)
+{
+    std::atomic<int> next_task = 0;
+    auto worker = [&](int w)
+    {
+        for (int i = next_task++; i < num_tasks; i = next_task++)
+        {
+            if constexpr (std::is_invocable_v<Function &, int, int>)
+            {
+                f(i, w);
+            }
+            else
+            {
+                f(i);
+            }
+        }
+    };
+    std::vector<std::thread> threads;
+    for (int t = 1; t < std::min(num_threads, num_tasks); t++)
+    {
+        threads.emplace_back(worker, t);
+    }
+    worker(0);
+    for (auto &t : threads)
+    {
+        t.join();
+    }
+}
+
+int default_num_threads()
+{
+    return std::max(1u, std::thread::hardware_concurrency());
+}
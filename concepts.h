@@ -0,0 +1,37 @@
+#pragma once
+
+#include <concepts>
+#include <string>
+
+#include "common.h"
+
+// exact word lookup, e.g. Trie, TrieArray, StaticTrieGraph or PerfectHashWordSet
+template <typename T>
+concept MembershipIndex = std::constructible_from<T, WordList &> && requires(T index, std::string &s) {
+    {
+        index.contains_word(s)
+    } -> std::convertible_to<bool>;
+};
+
+template <typename E>
+concept TrieEdgeLike = requires(E e) {
+    {
+        e.get_id()
+    } -> std::convertible_to<int>;
+    {
+        e.get_letter()
+    } -> std::same_as<char>;
+    {
+        e.is_word()
+    } -> std::convertible_to<bool>;
+};
+
+// trie as a graph rooted at node 0, edges are sorted by letter and mark whether their target is a word
+template <typename G>
+concept TraversableTrieGraph = TrieEdgeLike<typename G::Edge> && requires(G graph, int v) {
+    {
+        graph.num_nodes()
+    } -> std::convertible_to<int>;
+    graph.neighbors(v).begin();
+    graph.neighbors(v).end();
+};
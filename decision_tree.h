@@ -0,0 +1,469 @@
+#pragma once
+
+#include <vector>
+#include <string>
+#include <algorithm>
+#include <tuple>
+#include <unordered_set>
+#include <fstream>
+#include <cmath>
+#include <cstdint>
+
+#include "common.h"
+#include "feedback.h"
+
+enum TreeObjective
+{
+    WORST_CASE,
+    EXPECTED,
+};
+
+std::string tree_objective_to_string(TreeObjective objective)
+{
+    if (objective == TreeObjective::WORST_CASE)
+    {
+        return "worst_case";
+    }
+    else if (objective == TreeObjective::EXPECTED)
+    {
+        return "expected";
+    }
+    else
+    {
+        return "";
+    }
+}
+
+// wordle strategy for one word length: a node holds the guess for the secrets that are consistent
+// with the hints on its path, its children are sorted by pattern code; a correct guess has no child
+struct DecisionTree
+{
+    static constexpr uint64_t FILE_MAGIC = 0x31455254444c5257ULL;
+    // lengths with a feedback table
+    static constexpr int MAX_LENGTH = FeedbackMatrix::MAX_TABLE_LENGTH;
+
+    struct Node
+    {
+        int32_t guess;
+        uint32_t num_secrets;
+        uint32_t first_child;
+        uint32_t num_children;
+    };
+
+    struct Child
+    {
+        uint32_t code;
+        uint32_t node;
+    };
+
+    struct FileHeader
+    {
+        uint64_t magic;
+        uint64_t length;
+        uint64_t objective;
+        uint64_t dictionary_hash;
+        uint64_t num_nodes;
+        uint64_t num_children;
+        uint64_t max_depth;
+        uint64_t total_depth;
+        uint64_t num_secrets;
+    };
+
+    // -1 if no secret answers the guess of v with this pattern
+    int child(int v, uint32_t code) const
+    {
+        auto begin = children.begin() + nodes[v].first_child;
+        auto end = begin + nodes[v].num_children;
+        auto it = std::lower_bound(begin, end, code, [](const Child &c, uint32_t x)
+                                   { return c.code < x; });
+        return it != end && it->code == code ? (int)it->node : -1;
+    }
+
+    // appends t as subtree, returns its root
+    int append(DecisionTree &t)
+    {
+        int node_offset = nodes.size();
+        int child_offset = children.size();
+        for (Node v : t.nodes)
+        {
+            v.first_child += child_offset;
+            nodes.push_back(v);
+        }
+        for (Child c : t.children)
+        {
+            c.node += node_offset;
+            children.push_back(c);
+        }
+        return node_offset;
+    }
+
+    double avg_depth() const { return num_secrets > 0 ? (double)total_depth / num_secrets : 0; }
+
+    size_t memory_bytes() const { return nodes.size() * sizeof(Node) + children.size() * sizeof(Child); }
+
+    void save(std::string &path, uint64_t dictionary_hash)
+    {
+        std::ofstream file(path, std::ios::binary);
+        if (!file.is_open())
+        {
+            std::cerr << "Warning: Unable to write the decision tree: " << path << std::endl;
+            return;
+        }
+        FileHeader header{FILE_MAGIC, (uint64_t)length, (uint64_t)objective, dictionary_hash, nodes.size(), children.size(), (uint64_t)max_depth, (uint64_t)total_depth, (uint64_t)num_secrets};
+        file.write(reinterpret_cast<const char *>(&header), sizeof(header));
+        file.write(reinterpret_cast<const char *>(nodes.data()), nodes.size() * sizeof(Node));
+        file.write(reinterpret_cast<const char *>(children.data()), children.size() * sizeof(Child));
+    }
+
+    // false if the file is missing, belongs to another dictionary or objective, or is not a
+    // well formed tree whose guesses are words of the length
+    bool load(std::string &path, int _length, TreeObjective _objective, uint64_t dictionary_hash, WordList &words)
+    {
+        std::ifstream file(path, std::ios::binary | std::ios::ate);
+        FileHeader header;
+        if (!file.is_open())
+        {
+            return false;
+        }
+        uint64_t file_bytes = file.tellg();
+        file.seekg(0);
+        if (!file.read(reinterpret_cast<char *>(&header), sizeof(header)))
+        {
+            return false;
+        }
+        if (header.magic != FILE_MAGIC || header.length != (uint64_t)_length || header.objective != (uint64_t)_objective || header.dictionary_hash != dictionary_hash)
+        {
+            return false;
+        }
+        // sizes are checked against the file before anything is allocated
+        uint64_t body_bytes = file_bytes - sizeof(header);
+        if (header.num_nodes == 0 || header.num_nodes > body_bytes / sizeof(Node) || header.num_children > UINT32_MAX ||
+            header.num_nodes * sizeof(Node) + header.num_children * sizeof(Child) != body_bytes)
+        {
+            return false;
+        }
+        nodes.resize(header.num_nodes);
+        children.resize(header.num_children);
+        file.read(reinterpret_cast<char *>(nodes.data()), nodes.size() * sizeof(Node));
+        file.read(reinterpret_cast<char *>(children.data()), children.size() * sizeof(Child));
+        if (!file || !is_well_formed(words, _length))
+        {
+            nodes.clear();
+            children.clear();
+            return false;
+        }
+        length = _length;
+        objective = _objective;
+        max_depth = header.max_depth;
+        total_depth = header.total_depth;
+        num_secrets = header.num_secrets;
+        return true;
+    }
+
+    // child ranges and child nodes lie in the tree, guesses are indices of words of the length,
+    // anything else would index the feedback table row of another length
+    bool is_well_formed(WordList &words, int word_length) const
+    {
+        for (const Node &v : nodes)
+        {
+            if (v.guess < 0 || (size_t)v.guess >= words.size() || (int)words[v.guess].size() != word_length ||
+                (uint64_t)v.first_child + v.num_children > children.size())
+            {
+                return false;
+            }
+        }
+        for (const Child &c : children)
+        {
+            if (c.node >= nodes.size())
+            {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    std::vector<Node> nodes;
+    std::vector<Child> children;
+    int length = 0;
+    TreeObjective objective = TreeObjective::WORST_CASE;
+    // in guesses, over all secrets
+    int max_depth = 0;
+    long long total_depth = 0;
+    int num_secrets = 0;
+};
+
+// decision tree over all words of one length, every word may be guessed
+//
+// at each node the guesses are ranked by the partition of the remaining secrets (largest class
+// for the worst case, sum of c * log2(c) for the expected depth) and the subtrees of the best
+// beam_width guesses are built; a guess is abandoned as soon as the subtrees built so far and a
+// lower bound for the others cannot beat the best one; the root's subtrees are built in parallel
+struct DecisionTreeSolver
+{
+    struct GuessScore
+    {
+        double primary;
+        int secondary;
+        bool not_secret;
+        int guess;
+
+        bool operator<(const GuessScore &o) const
+        {
+            return std::tie(primary, secondary, not_secret, guess) < std::tie(o.primary, o.secondary, o.not_secret, o.guess);
+        }
+    };
+
+    DecisionTreeSolver(FeedbackTable &_table, TreeObjective _objective, int _beam_width = 4, int _num_threads = default_num_threads())
+        : table(_table), objective(_objective), beam_width(_beam_width), num_threads(_num_threads)
+    {
+        assert(!table.lazy);
+        n = table.n;
+        // equal words are the same secret and the same guess
+        std::unordered_set<std::string> seen;
+        for (int i = 0; i < n; i++)
+        {
+            if (seen.insert(table.words[table.word_indices[i]]).second)
+            {
+                unique_words.push_back(i);
+            }
+        }
+        n_log_n.resize(n + 1, 0);
+        for (int c = 1; c <= n; c++)
+        {
+            n_log_n[c] = c * std::log2(c);
+        }
+    }
+
+    DecisionTree solve()
+    {
+        DecisionTree tree = solve_subset(unique_words, 0);
+        tree.length = table.length;
+        tree.objective = objective;
+        tree.num_secrets = unique_words.size();
+        return tree;
+    }
+
+    // (max depth, total depth) or (total depth, max depth)
+    std::pair<long long, long long> key(long long max_depth, long long total_depth) const
+    {
+        if (objective == TreeObjective::WORST_CASE)
+        {
+            return {max_depth, total_depth};
+        }
+        return {total_depth, max_depth};
+    }
+
+    uint32_t all_green() const { return num_pattern_codes(table.length) - 1; }
+
+    // classes of secrets by pattern code, sorted by code
+    std::vector<std::pair<uint32_t, std::vector<int>>> partition(int g, std::vector<int> &secrets)
+    {
+        std::vector<std::pair<uint32_t, int>> coded;
+        coded.reserve(secrets.size());
+        for (int s : secrets)
+        {
+            coded.push_back({table.code(g, s), s});
+        }
+        std::sort(coded.begin(), coded.end());
+        std::vector<std::pair<uint32_t, std::vector<int>>> classes;
+        for (auto [code, s] : coded)
+        {
+            if (classes.empty() || classes.back().first != code)
+            {
+                classes.push_back({code, {}});
+            }
+            classes.back().second.push_back(s);
+        }
+        return classes;
+    }
+
+    GuessScore score(int g, std::vector<int> &secrets, std::vector<uint16_t> &histogram, std::vector<uint32_t> &codes, bool guess_is_secret)
+    {
+        int m = secrets.size();
+        codes.resize(m);
+        int max_class = 0;
+        int num_classes = 0;
+        double sum = 0;
+        for (int i = 0; i < m; i++)
+        {
+            codes[i] = table.code(g, secrets[i]);
+            int c = ++histogram[codes[i]];
+            max_class = std::max(max_class, c);
+            num_classes += c == 1;
+        }
+        for (int i = 0; i < m; i++)
+        {
+            sum += n_log_n[histogram[codes[i]]];
+            histogram[codes[i]] = 0;
+        }
+        if (objective == TreeObjective::WORST_CASE)
+        {
+            return {(double)max_class, -num_classes, !guess_is_secret, g};
+        }
+        return {sum, max_class, !guess_is_secret, g};
+    }
+
+    // a subset of the secrets needs at least 2 * size - 1 guesses in total and depth 2 if size > 1
+    static long long total_lower_bound(long long size) { return 2 * size - 1; }
+
+    // the guess identifies every other secret, each of them is guessed next
+    DecisionTree leaf_tree(std::vector<int> &secrets, int guess, std::vector<std::pair<uint32_t, std::vector<int>>> &classes)
+    {
+        DecisionTree tree;
+        tree.nodes.push_back({table.word_indices[guess], (uint32_t)secrets.size(), 0, 0});
+        tree.max_depth = 1;
+        tree.total_depth = secrets.size();
+        for (auto &[code, members] : classes)
+        {
+            if (code == all_green())
+                continue;
+            tree.children.push_back({code, (uint32_t)tree.nodes.size()});
+            tree.nodes.push_back({table.word_indices[members[0]], 1, 0, 0});
+            tree.max_depth = 2;
+            tree.total_depth += 1;
+        }
+        tree.nodes[0].num_children = tree.children.size();
+        return tree;
+    }
+
+    DecisionTree solve_subset(std::vector<int> &secrets, int depth)
+    {
+        int m = secrets.size();
+        if (m <= 2)
+        {
+            auto classes = partition(secrets[0], secrets);
+            return leaf_tree(secrets, secrets[0], classes);
+        }
+
+        // rank all guesses, guesses that do not split the secrets make no progress
+        std::vector<GuessScore> scores(unique_words.size());
+        std::vector<bool> in_subset(n, false);
+        for (int s : secrets)
+        {
+            in_subset[s] = true;
+        }
+        auto score_range = [&](int begin, int end)
+        {
+            // entries are cleared again by score
+            thread_local std::vector<uint16_t> histogram;
+            thread_local std::vector<uint32_t> codes;
+            histogram.resize(std::max<size_t>(histogram.size(), num_pattern_codes(table.length)), 0);
+            for (int i = begin; i < end; i++)
+            {
+                int g = unique_words[i];
+                scores[i] = score(g, secrets, histogram, codes, in_subset[g]);
+            }
+        };
+        int num_guesses = unique_words.size();
+        if (depth == 0)
+        {
+            int block = 64;
+            parallel_for_each((num_guesses + block - 1) / block, num_threads, [&](int b)
+                              { score_range(b * block, std::min(num_guesses, (b + 1) * block)); });
+        }
+        else
+        {
+            score_range(0, num_guesses);
+        }
+        std::vector<GuessScore> progress;
+        for (auto &sc : scores)
+        {
+            bool no_progress = objective == TreeObjective::WORST_CASE ? sc.primary == m : sc.secondary == m;
+            if (!(no_progress && sc.not_secret))
+            {
+                progress.push_back(sc);
+            }
+        }
+        int width = std::min<int>(beam_width, progress.size());
+        std::partial_sort(progress.begin(), progress.begin() + width, progress.end());
+
+        DecisionTree best;
+        bool found = false;
+        for (int b = 0; b < width; b++)
+        {
+            int g = progress[b].guess;
+            auto classes = partition(g, secrets);
+            int max_class = 0;
+            for (auto &[code, members] : classes)
+            {
+                max_class = std::max<int>(max_class, members.size());
+            }
+            // every other secret is identified by this guess
+            if (max_class == 1 && in_subset[g])
+            {
+                return leaf_tree(secrets, g, classes);
+            }
+
+            DecisionTree candidate;
+            if (expand(candidate, g, secrets, classes, depth, found ? &best : nullptr) && (!found || key(candidate.max_depth, candidate.total_depth) < key(best.max_depth, best.total_depth)))
+            {
+                best = std::move(candidate);
+                found = true;
+            }
+        }
+        return best;
+    }
+
+    // builds the subtree with guess g at the root, false if it cannot beat bound
+    bool expand(DecisionTree &tree, int g, std::vector<int> &secrets, std::vector<std::pair<uint32_t, std::vector<int>>> &classes, int depth, DecisionTree *bound)
+    {
+        std::vector<int> child_classes;
+        long long lower_total = secrets.size();
+        int lower_max = 1;
+        for (uint i = 0; i < classes.size(); i++)
+        {
+            if (classes[i].first == all_green())
+                continue;
+            child_classes.push_back(i);
+            long long size = classes[i].second.size();
+            lower_total += total_lower_bound(size);
+            lower_max = std::max(lower_max, size == 1 ? 2 : 3);
+        }
+
+        std::vector<DecisionTree> subtrees(child_classes.size());
+        if (depth == 0)
+        {
+            parallel_for_each(child_classes.size(), num_threads, [&](int i)
+                              { subtrees[i] = solve_subset(classes[child_classes[i]].second, depth + 1); });
+        }
+        else
+        {
+            // bounds are replaced by the subtrees one by one
+            for (uint i = 0; i < child_classes.size(); i++)
+            {
+                if (bound != nullptr && key(lower_max, lower_total) >= key(bound->max_depth, bound->total_depth))
+                {
+                    return false;
+                }
+                auto &members = classes[child_classes[i]].second;
+                subtrees[i] = solve_subset(members, depth + 1);
+                lower_total += subtrees[i].total_depth - total_lower_bound(members.size());
+                lower_max = std::max(lower_max, 1 + subtrees[i].max_depth);
+            }
+        }
+
+        tree.nodes.push_back({table.word_indices[g], (uint32_t)secrets.size(), 0, (uint32_t)child_classes.size()});
+        tree.children.resize(child_classes.size());
+        tree.max_depth = 1;
+        tree.total_depth = secrets.size();
+        for (uint i = 0; i < child_classes.size(); i++)
+        {
+            tree.children[i].code = classes[child_classes[i]].first;
+            tree.max_depth = std::max(tree.max_depth, 1 + subtrees[i].max_depth);
+            tree.total_depth += subtrees[i].total_depth;
+        }
+        for (uint i = 0; i < child_classes.size(); i++)
+        {
+            tree.children[i].node = tree.append(subtrees[i]);
+        }
+        return bound == nullptr || key(tree.max_depth, tree.total_depth) < key(bound->max_depth, bound->total_depth);
+    }
+
+    FeedbackTable &table;
+    TreeObjective objective;
+    int beam_width;
+    int num_threads;
+    int n;
+    std::vector<int> unique_words;
+    std::vector<double> n_log_n;
+};
@@ -0,0 +1,455 @@
+#pragma once
+
+#include <vector>
+#include <string>
+#include <string_view>
+#include <memory>
+#include <mutex>
+#include <fstream>
+#include <iostream>
+#include <cstdint>
+#include <algorithm>
+#ifdef __AVX2__
+#include <immintrin.h>
+#endif
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#include "common.h"
+#include "bloom_filter.h"
+#include "measure_time.h"
+
+// longest words whose feedback fits into a 64 bit pattern code
+static constexpr int MAX_PATTERN_LENGTH = 40;
+
+// feedback of a guess as base 3 number, digit i is the WordleHintChar of position i, i.e.
+// 0 does not occur, 1 different position, 2 correct position; same semantics as get_wordle_hint
+inline uint64_t pattern_code(std::string_view guess, std::string_view secret)
+{
+    assert(guess.size() == secret.size() && (int)guess.size() <= MAX_PATTERN_LENGTH);
+    int n = guess.size();
+    uint8_t count[26] = {};
+    for (int i = 0; i < n; i++)
+    {
+        if (guess[i] != secret[i])
+        {
+            count[secret[i] - 'a']++;
+        }
+    }
+    uint64_t code = 0;
+    uint64_t power = 1;
+    for (int i = 0; i < n; i++)
+    {
+        uint64_t digit = 2;
+        if (guess[i] != secret[i])
+        {
+            // letters are marked yellow from left to right
+            uint8_t &c = count[guess[i] - 'a'];
+            digit = c > 0;
+            c -= c > 0;
+        }
+        code += digit * power;
+        power *= 3;
+    }
+    return code;
+}
+
+inline uint64_t num_pattern_codes(int length)
+{
+    uint64_t n = 1;
+    for (int i = 0; i < length; i++)
+    {
+        n *= 3;
+    }
+    return n;
+}
+
+// longest words whose pattern code fits into 32 bits
+static constexpr int MAX_BATCH_LENGTH = 20;
+
+// words of one length stored position major for batch_pattern_codes, letter i of the j-th word
+// is at letters[i * stride + j], stride is a multiple of 32
+struct SecretBatch
+{
+    static constexpr int LANES = 32;
+
+    SecretBatch(WordList &words, std::vector<int> &word_indices)
+    {
+        n = word_indices.size();
+        length = n > 0 ? words[word_indices[0]].size() : 0;
+        assert(length <= MAX_BATCH_LENGTH);
+        stride = (n + LANES - 1) / LANES * LANES;
+        letters.assign((size_t)length * stride, 0);
+        for (int j = 0; j < n; j++)
+        {
+            std::string &w = words[word_indices[j]];
+            assert((int)w.size() == length);
+            for (int i = 0; i < length; i++)
+            {
+                letters[(size_t)i * stride + j] = w[i] - 'a';
+            }
+        }
+    }
+
+    const uint8_t *position(int i) const { return letters.data() + (size_t)i * stride; }
+
+    int n;
+    int length;
+    int stride;
+    std::vector<uint8_t> letters;
+};
+
+// pattern codes of guess against all words of the batch, codes needs room for batch.stride values
+//
+// the i-th non green occurrence of a letter in the guess is yellow if the secret has more than i
+// non green copies of it, which is the left to right assignment of get_wordle_hint; with AVX2 one
+// register holds the letters of 32 secrets at one position
+void batch_pattern_codes(std::string_view guess, const SecretBatch &batch, uint32_t *codes)
+{
+    int n = batch.length;
+    assert((int)guess.size() == n);
+    uint8_t g[MAX_BATCH_LENGTH];
+    // slot of the letter among the distinct letters of the guess
+    int slot[MAX_BATCH_LENGTH];
+    uint8_t distinct[MAX_BATCH_LENGTH];
+    int num_distinct = 0;
+    for (int i = 0; i < n; i++)
+    {
+        g[i] = guess[i] - 'a';
+        slot[i] = std::find(distinct, distinct + num_distinct, g[i]) - distinct;
+        if (slot[i] == num_distinct)
+        {
+            distinct[num_distinct++] = g[i];
+        }
+    }
+
+    for (int j = 0; j < batch.stride; j += SecretBatch::LANES)
+    {
+#ifdef __AVX2__
+        __m256i secret[MAX_BATCH_LENGTH];
+        __m256i green[MAX_BATCH_LENGTH];
+        __m256i available[MAX_BATCH_LENGTH];
+        __m256i rank[MAX_BATCH_LENGTH];
+        for (int i = 0; i < n; i++)
+        {
+            secret[i] = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(batch.position(i) + j));
+            green[i] = _mm256_cmpeq_epi8(secret[i], _mm256_set1_epi8(g[i]));
+        }
+        // non green copies in the secret, counted by subtracting the -1 of a match
+        for (int d = 0; d < num_distinct; d++)
+        {
+            __m256i letter = _mm256_set1_epi8(distinct[d]);
+            available[d] = _mm256_setzero_si256();
+            rank[d] = _mm256_setzero_si256();
+            for (int i = 0; i < n; i++)
+            {
+                __m256i match = _mm256_andnot_si256(green[i], _mm256_cmpeq_epi8(secret[i], letter));
+                available[d] = _mm256_sub_epi8(available[d], match);
+            }
+        }
+        __m256i all_ones = _mm256_set1_epi8(-1);
+        __m256i digit[MAX_BATCH_LENGTH];
+        for (int i = 0; i < n; i++)
+        {
+            int d = slot[i];
+            __m256i yellow = _mm256_andnot_si256(green[i], _mm256_cmpgt_epi8(available[d], rank[d]));
+            rank[d] = _mm256_sub_epi8(rank[d], _mm256_andnot_si256(green[i], all_ones));
+            digit[i] = _mm256_or_si256(_mm256_and_si256(green[i], _mm256_set1_epi8(2)), _mm256_and_si256(yellow, _mm256_set1_epi8(1)));
+        }
+        // horner scheme in 32 bit lanes, 8 secrets at a time
+        for (int q = 0; q < 4; q++)
+        {
+            __m256i code = _mm256_setzero_si256();
+            for (int i = n - 1; i >= 0; i--)
+            {
+                __m128i part = q < 2 ? _mm256_castsi256_si128(digit[i]) : _mm256_extracti128_si256(digit[i], 1);
+                __m256i wide = _mm256_cvtepu8_epi32(q % 2 == 0 ? part : _mm_srli_si128(part, 8));
+                code = _mm256_add_epi32(_mm256_add_epi32(_mm256_slli_epi32(code, 1), code), wide);
+            }
+            _mm256_storeu_si256(reinterpret_cast<__m256i *>(codes + j + 8 * q), code);
+        }
+#else
+        for (int k = j; k < j + SecretBatch::LANES; k++)
+        {
+            uint8_t available[MAX_BATCH_LENGTH] = {};
+            uint8_t rank[MAX_BATCH_LENGTH] = {};
+            uint8_t digit[MAX_BATCH_LENGTH];
+            for (int i = 0; i < n; i++)
+            {
+                uint8_t c = batch.position(i)[k];
+                for (int d = 0; d < num_distinct; d++)
+                {
+                    available[d] += c == distinct[d] && c != g[i];
+                }
+            }
+            for (int i = 0; i < n; i++)
+            {
+                bool green = batch.position(i)[k] == g[i];
+                digit[i] = green ? 2 : rank[slot[i]] < available[slot[i]];
+                rank[slot[i]] += !green;
+            }
+            uint32_t code = 0;
+            for (int i = n - 1; i >= 0; i--)
+            {
+                code = code * 3 + digit[i];
+            }
+            codes[k] = code;
+        }
+#endif
+    }
+}
+
+// pattern codes of all guess and secret pairs of one word length
+//
+// rows are guesses and columns secrets, both in the order of the word indices; tables that
+// exceed the memory limit are split into blocks of rows that are computed on first use
+struct FeedbackTable
+{
+    static constexpr int BLOCK_ROWS = 64;
+    static constexpr uint64_t CACHE_MAGIC = 0x31424446454c5257ULL;
+
+    struct CacheHeader
+    {
+        uint64_t magic;
+        uint64_t length;
+        uint64_t num_words;
+        uint64_t dictionary_hash;
+    };
+
+    FeedbackTable(WordList &_words, std::vector<int> &_word_indices, int _length, size_t max_table_bytes, std::string cache_file, int _num_threads)
+        : words(_words), word_indices(_word_indices), secrets(_words, _word_indices), length(_length), num_threads(_num_threads)
+    {
+        assert(length <= 10);
+        n = word_indices.size();
+        code_bytes = num_pattern_codes(length) <= 256 ? 1 : 2;
+        size_t table_bytes = (size_t)n * n * code_bytes;
+        int num_blocks = (n + BLOCK_ROWS - 1) / BLOCK_ROWS;
+
+        build_time_ms = measureTimeMs([&]()
+                                      {
+            if (table_bytes > max_table_bytes)
+            {
+                lazy = true;
+                blocks.resize(num_blocks);
+                block_once = std::make_unique<std::once_flag[]>(num_blocks);
+                return;
+            }
+            if (!cache_file.empty() && map_cache(cache_file))
+            {
+                return;
+            }
+            owned.resize(table_bytes);
+            parallel_for_each(num_blocks, num_threads, [&](int b)
+                              { compute_rows(b * BLOCK_ROWS, std::min(n, (b + 1) * BLOCK_ROWS), owned.data() + (size_t)b * BLOCK_ROWS * n * code_bytes); });
+            data = owned.data();
+            if (!cache_file.empty())
+            {
+                write_cache(cache_file);
+            } });
+    }
+
+    ~FeedbackTable()
+    {
+        if (mapped != nullptr)
+        {
+            munmap(mapped, mapped_bytes);
+        }
+    }
+
+    FeedbackTable(const FeedbackTable &) = delete;
+    FeedbackTable &operator=(const FeedbackTable &) = delete;
+
+    void compute_rows(int begin, int end, uint8_t *out)
+    {
+        std::vector<uint32_t> codes(secrets.stride);
+        for (int g = begin; g < end; g++)
+        {
+            batch_pattern_codes(words[word_indices[g]], secrets, codes.data());
+            for (int s = 0; s < n; s++)
+            {
+                if (code_bytes == 1)
+                    out[s] = codes[s];
+                else
+                    reinterpret_cast<uint16_t *>(out)[s] = codes[s];
+            }
+            out += (size_t)n * code_bytes;
+        }
+    }
+
+    // pointer to the pattern codes of guess g against all secrets, uint16_t if code_bytes is 2
+    const uint8_t *row(int g)
+    {
+        if (!lazy)
+        {
+            return data + (size_t)g * n * code_bytes;
+        }
+        int b = g / BLOCK_ROWS;
+        std::call_once(block_once[b], [&]()
+                       {
+            int begin = b * BLOCK_ROWS;
+            int end = std::min(n, begin + BLOCK_ROWS);
+            blocks[b].resize((size_t)(end - begin) * n * code_bytes);
+            compute_rows(begin, end, blocks[b].data()); });
+        return blocks[b].data() + (size_t)(g % BLOCK_ROWS) * n * code_bytes;
+    }
+
+    // g and s are positions in word_indices
+    inline uint32_t code(int g, int s)
+    {
+        const uint8_t *r = row(g);
+        return code_bytes == 1 ? r[s] : reinterpret_cast<const uint16_t *>(r)[s];
+    }
+
+    uint64_t dictionary_hash()
+    {
+        uint64_t h = length;
+        for (int i : word_indices)
+        {
+            h = mix_hash(h ^ hash_string(words[i]));
+        }
+        return h;
+    }
+
+    bool map_cache(std::string &path)
+    {
+        int fd = open(path.c_str(), O_RDONLY);
+        if (fd == -1)
+        {
+            return false;
+        }
+        struct stat st;
+        size_t expected = sizeof(CacheHeader) + (size_t)n * n * code_bytes;
+        if (fstat(fd, &st) != 0 || (size_t)st.st_size != expected)
+        {
+            close(fd);
+            return false;
+        }
+        void *p = mmap(nullptr, expected, PROT_READ, MAP_PRIVATE, fd, 0);
+        close(fd);
+        if (p == MAP_FAILED)
+        {
+            return false;
+        }
+        CacheHeader header = *static_cast<CacheHeader *>(p);
+        if (header.magic != CACHE_MAGIC || header.length != (uint64_t)length || header.num_words != (uint64_t)n || header.dictionary_hash != dictionary_hash())
+        {
+            munmap(p, expected);
+            return false;
+        }
+        mapped = p;
+        mapped_bytes = expected;
+        data = static_cast<const uint8_t *>(p) + sizeof(CacheHeader);
+        from_cache = true;
+        return true;
+    }
+
+    void write_cache(std::string &path)
+    {
+        std::ofstream file(path, std::ios::binary);
+        if (!file.is_open())
+        {
+            std::cerr << "Warning: Unable to write the feedback cache: " << path << std::endl;
+            return;
+        }
+        CacheHeader header{CACHE_MAGIC, (uint64_t)length, (uint64_t)n, dictionary_hash()};
+        file.write(reinterpret_cast<const char *>(&header), sizeof(header));
+        file.write(reinterpret_cast<const char *>(owned.data()), owned.size());
+    }
+
+    size_t memory_bytes() const
+    {
+        size_t bytes = owned.size() + mapped_bytes;
+        for (auto &block : blocks)
+        {
+            bytes += block.size();
+        }
+        return bytes;
+    }
+
+    WordList &words;
+    std::vector<int> word_indices;
+    SecretBatch secrets;
+    int length;
+    int n;
+    int code_bytes;
+    int num_threads;
+
+    const uint8_t *data = nullptr;
+    std::vector<uint8_t> owned;
+    void *mapped = nullptr;
+    size_t mapped_bytes = 0;
+
+    bool lazy = false;
+    std::vector<std::vector<uint8_t>> blocks;
+    std::unique_ptr<std::once_flag[]> block_once;
+
+    bool from_cache = false;
+    int build_time_ms = 0;
+};
+
+// feedback tables of every word length up to 10, built on first use of a length
+struct FeedbackMatrix
+{
+    static constexpr int MAX_TABLE_LENGTH = 10;
+
+    // an empty cache_dir disables the disk cache
+    FeedbackMatrix(WordList &_words, std::string _cache_dir = "", size_t _max_table_bytes = 256 << 20, int _num_threads = default_num_threads())
+        : words(_words), cache_dir(_cache_dir), max_table_bytes(_max_table_bytes), num_threads(_num_threads)
+    {
+        words_of_len = compute_index_word_of_len(words);
+        tables.resize(std::min<int>(words_of_len.size(), MAX_TABLE_LENGTH + 1));
+        table_once = std::make_unique<std::once_flag[]>(tables.size());
+    }
+
+    bool has_table(int length) const
+    {
+        return length < (int)tables.size() && !words_of_len[length].empty();
+    }
+
+    FeedbackTable &table(int length)
+    {
+        assert(has_table(length));
+        std::call_once(table_once[length], [&]()
+                       {
+            std::string cache_file = cache_dir.empty() ? "" : cache_dir + "/feedback_" + std::to_string(length) + ".bin";
+            tables[length] = std::make_unique<FeedbackTable>(words, words_of_len[length], length, max_table_bytes, cache_file, num_threads); });
+        return *tables[length];
+    }
+
+    // word indices of equal length
+    uint64_t code_of_words(int guess, int secret)
+    {
+        int length = words[guess].size();
+        if (!has_table(length))
+        {
+            return pattern_code(words[guess], words[secret]);
+        }
+        auto &index = words_of_len[length];
+        int g = std::lower_bound(index.begin(), index.end(), guess) - index.begin();
+        int s = std::lower_bound(index.begin(), index.end(), secret) - index.begin();
+        return table(length).code(g, s);
+    }
+
+    void print_report()
+    {
+        std::cout << "length words code_bytes mode build_time[ms] memory[KB]\n";
+        for (int len = 1; len < (int)tables.size(); len++)
+        {
+            if (!has_table(len))
+                continue;
+            auto &t = table(len);
+            std::string mode = t.lazy ? "lazy" : (t.from_cache ? "cached" : "full");
+            std::cout << len << " " << t.n << " " << t.code_bytes << " " << mode << " " << t.build_time_ms << " " << t.memory_bytes() / 1024 << "\n";
+        }
+    }
+
+    WordList &words;
+    std::string cache_dir;
+    size_t max_table_bytes;
+    int num_threads;
+    std::vector<std::vector<int>> words_of_len;
+    std::vector<std::unique_ptr<FeedbackTable>> tables;
+    std::unique_ptr<std::once_flag[]> table_once;
+};
@@ -0,0 +1,279 @@
+#pragma once
+
+#include <vector>
+#include <string>
+#include <string_view>
+#include <algorithm>
+#include <bit>
+#include <cstdint>
+
+#include "common.h"
+
+// suffix array of text by prefix doubling, every round sorts by (rank[i], rank[i + k]) with
+// two counting sorts, text must end with a unique smallest symbol
+std::vector<int> build_suffix_array(std::vector<uint8_t> &text, int alphabet_size)
+{
+    int n = text.size();
+    std::vector<int> sa(n), rank(n), tmp(n), count(std::max(n, alphabet_size) + 1);
+
+    for (int i = 0; i < n; i++)
+        count[text[i]]++;
+    for (int c = 1; c < alphabet_size; c++)
+        count[c] += count[c - 1];
+    for (int i = n - 1; i >= 0; i--)
+        sa[--count[text[i]]] = i;
+    rank[sa[0]] = 0;
+    for (int i = 1; i < n; i++)
+        rank[sa[i]] = rank[sa[i - 1]] + (text[sa[i]] != text[sa[i - 1]]);
+
+    for (int k = 1; rank[sa[n - 1]] < n - 1; k <<= 1)
+    {
+        // order by second key: suffixes without a second half first, then by the current order
+        int p = 0;
+        for (int i = n - k; i < n; i++)
+            tmp[p++] = i;
+        for (int i = 0; i < n; i++)
+            if (sa[i] >= k)
+                tmp[p++] = sa[i] - k;
+
+        // stable counting sort by first key
+        int num_ranks = rank[sa[n - 1]] + 1;
+        std::fill(count.begin(), count.begin() + num_ranks, 0);
+        for (int i = 0; i < n; i++)
+            count[rank[i]]++;
+        for (int r = 1; r < num_ranks; r++)
+            count[r] += count[r - 1];
+        for (int i = n - 1; i >= 0; i--)
+            sa[--count[rank[tmp[i]]]] = tmp[i];
+
+        auto second = [&](int i)
+        { return i + k < n ? rank[i + k] : -1; };
+        tmp[sa[0]] = 0;
+        for (int i = 1; i < n; i++)
+        {
+            bool same = rank[sa[i]] == rank[sa[i - 1]] && second(sa[i]) == second(sa[i - 1]);
+            tmp[sa[i]] = tmp[sa[i - 1]] + !same;
+        }
+        std::swap(rank, tmp);
+    }
+    return sa;
+}
+
+// FM-index over "#w1#w2#...#wn#" for substring, prefix and suffix queries on the whole dictionary
+//
+// backward search narrows the range of suffixes that start with the pattern one letter at a time
+// using the occurrence counts of the BWT, which are stored for every block of 64 symbols and
+// completed by scanning the block; text positions are recovered from a sampled suffix array and
+// word ids from the suffix array entries of the separators
+struct FMIndex
+{
+    static constexpr uint8_t SENTINEL = 0;
+    static constexpr uint8_t SEPARATOR = 1;
+    static constexpr int ALPHABET_SIZE = 28;
+    static constexpr int BLOCK_SIZE = 64;
+    static constexpr int SAMPLE_RATE = 32;
+
+    FMIndex(WordList &words)
+    {
+        std::vector<int> word_starts;
+        std::vector<uint8_t> text;
+        text.push_back(SEPARATOR);
+        for (auto &w : words)
+        {
+            word_starts.push_back(text.size());
+            for (char c : w)
+            {
+                text.push_back(symbol(c));
+            }
+            text.push_back(SEPARATOR);
+        }
+        text.push_back(SENTINEL);
+        text_size = text.size();
+
+        std::vector<int> sa = build_suffix_array(text, ALPHABET_SIZE);
+        int n = text_size;
+
+        bwt.resize(n);
+        std::vector<uint32_t> count(ALPHABET_SIZE, 0);
+        int num_blocks = n / BLOCK_SIZE + 1;
+        occ_samples.resize(num_blocks * ALPHABET_SIZE);
+        sampled.assign(n / 64 + 1, 0);
+        for (int i = 0; i < n; i++)
+        {
+            if (i % BLOCK_SIZE == 0)
+            {
+                std::copy(count.begin(), count.end(), occ_samples.begin() + (i / BLOCK_SIZE) * ALPHABET_SIZE);
+            }
+            bwt[i] = sa[i] == 0 ? text[n - 1] : text[sa[i] - 1];
+            count[bwt[i]]++;
+            if (text[sa[i]] == SEPARATOR)
+            {
+                auto it = std::lower_bound(word_starts.begin(), word_starts.end(), sa[i] + 1);
+                separator_word.push_back(it == word_starts.end() ? -1 : it - word_starts.begin());
+            }
+            if (sa[i] % SAMPLE_RATE == 0)
+            {
+                sampled[i / 64] |= 1ULL << (i % 64);
+                sa_samples.push_back(sa[i]);
+            }
+        }
+        if (n % BLOCK_SIZE == 0)
+        {
+            std::copy(count.begin(), count.end(), occ_samples.begin() + (n / BLOCK_SIZE) * ALPHABET_SIZE);
+        }
+
+        sampled_rank.resize(sampled.size());
+        uint32_t rank = 0;
+        for (uint i = 0; i < sampled.size(); i++)
+        {
+            sampled_rank[i] = rank;
+            rank += std::popcount(sampled[i]);
+        }
+
+        first.assign(ALPHABET_SIZE + 1, 0);
+        for (int c = 0; c < ALPHABET_SIZE; c++)
+        {
+            first[c + 1] = first[c] + count[c];
+        }
+    }
+
+    static inline uint8_t symbol(char c)
+    {
+        return c == '#' ? SEPARATOR : c - 'a' + 2;
+    }
+
+    // occurrences of symbol c in bwt[0, i)
+    inline uint32_t occ(uint8_t c, int i) const
+    {
+        int block = i / BLOCK_SIZE;
+        uint32_t result = occ_samples[block * ALPHABET_SIZE + c];
+        for (int j = block * BLOCK_SIZE; j < i; j++)
+        {
+            result += bwt[j] == c;
+        }
+        return result;
+    }
+
+    // range of suffixes starting with pattern, '#' matches a word boundary
+    std::pair<int, int> find_range(std::string_view pattern) const
+    {
+        int lo = 0;
+        int hi = text_size;
+        for (int i = (int)pattern.size() - 1; i >= 0 && lo < hi; i--)
+        {
+            char c = pattern[i];
+            if (c != '#' && (c < 'a' || c > 'z'))
+            {
+                return {0, 0};
+            }
+            uint8_t s = symbol(c);
+            lo = first[s] + occ(s, lo);
+            hi = first[s] + occ(s, hi);
+        }
+        return {lo, hi};
+    }
+
+    int count(std::string_view pattern) const
+    {
+        auto [lo, hi] = find_range(pattern);
+        return hi - lo;
+    }
+
+    inline bool is_sampled(int i) const
+    {
+        return sampled[i / 64] & (1ULL << (i % 64));
+    }
+
+    // text position of the i-th smallest suffix by LF steps to the next sampled one
+    int locate(int i) const
+    {
+        int steps = 0;
+        while (!is_sampled(i))
+        {
+            uint8_t c = bwt[i];
+            i = first[c] + occ(c, i);
+            steps++;
+        }
+        uint64_t below = sampled[i / 64] & ((1ULL << (i % 64)) - 1);
+        return sa_samples[sampled_rank[i / 64] + std::popcount(below)] + steps;
+    }
+
+    std::vector<int> locate(std::string_view pattern) const
+    {
+        auto [lo, hi] = find_range(pattern);
+        std::vector<int> positions;
+        positions.reserve(hi - lo);
+        for (int i = lo; i < hi; i++)
+        {
+            positions.push_back(locate(i));
+        }
+        std::sort(positions.begin(), positions.end());
+        return positions;
+    }
+
+    // sorted ids of the words matching pattern, e.g. "ell", "ing#" for suffixes or "#re" for prefixes
+    //
+    // instead of locating text positions the match is extended backwards to the separator in
+    // front of its word, which takes at most the word length LF steps
+    std::vector<int> words_matching(std::string_view pattern) const
+    {
+        auto [lo, hi] = find_range(pattern);
+        std::vector<int> ids;
+        ids.reserve(hi - lo);
+        for (int row = lo; row < hi; row++)
+        {
+            int i = row;
+            if (pattern.empty() || pattern[0] != '#')
+            {
+                uint8_t c;
+                do
+                {
+                    c = bwt[i];
+                    i = first[c] + occ(c, i);
+                } while (c != SEPARATOR);
+            }
+            int id = separator_word[i - first[SEPARATOR]];
+            if (id != -1)
+            {
+                ids.push_back(id);
+            }
+        }
+        // a word can contain the pattern more than once
+        std::sort(ids.begin(), ids.end());
+        ids.erase(std::unique(ids.begin(), ids.end()), ids.end());
+        return ids;
+    }
+
+    std::vector<int> words_containing(std::string_view s) const
+    {
+        return words_matching(s);
+    }
+
+    std::vector<int> words_starting_with(std::string_view s) const
+    {
+        return words_matching("#" + std::string(s));
+    }
+
+    std::vector<int> words_ending_with(std::string_view s) const
+    {
+        return words_matching(std::string(s) + "#");
+    }
+
+    size_t memory_bytes() const
+    {
+        return bwt.size() * sizeof(uint8_t) + occ_samples.size() * sizeof(uint32_t) + sampled.size() * sizeof(uint64_t) + sampled_rank.size() * sizeof(uint32_t) + sa_samples.size() * sizeof(int) + separator_word.size() * sizeof(int) + first.size() * sizeof(int);
+    }
+
+    int text_size;
+    std::vector<uint8_t> bwt;
+    // occurrences of every symbol before each block
+    std::vector<uint32_t> occ_samples;
+    // positions in the suffix array whose suffix starts at a multiple of SAMPLE_RATE
+    std::vector<uint64_t> sampled;
+    std::vector<uint32_t> sampled_rank;
+    std::vector<int> sa_samples;
+    // word following each separator in suffix array order, -1 for the last one
+    std::vector<int> separator_word;
+    // number of symbols smaller than c
+    std::vector<int> first;
+};
@@ -0,0 +1,113 @@
+#pragma once
+
+#include <vector>
+#include <string>
+#include <algorithm>
+#include <numeric>
+
+#include "common.h"
+#include "static_trie.h"
+
+struct FuzzyMatch
+{
+    int word_index;
+    int distance;
+};
+
+// Levenshtein distance by the textbook dp, reference for FuzzySearch
+int edit_distance(const std::string &a, const std::string &b)
+{
+    std::vector<int> row(b.size() + 1);
+    std::iota(row.begin(), row.end(), 0);
+    for (uint i = 1; i <= a.size(); i++)
+    {
+        int diagonal = row[0];
+        row[0] = i;
+        for (uint j = 1; j <= b.size(); j++)
+        {
+            int up = row[j];
+            row[j] = std::min({row[j] + 1, row[j - 1] + 1, diagonal + (a[i - 1] != b[j - 1])});
+            diagonal = up;
+        }
+    }
+    return row[b.size()];
+}
+
+// all words within a bounded edit distance of a query
+//
+// the trie is walked depth first with one dp row per depth, the row of a node holds the distances
+// between its prefix and every prefix of the query, so a subtree can be skipped as soon as the
+// minimum of the row exceeds the bound
+struct FuzzySearch
+{
+    using EdgeType = CompressedTrieEdge;
+
+    FuzzySearch(WordList &_words) : words(_words), trie(_words)
+    {
+        node_to_word_index = trie.construct_node_to_word_index(words);
+    }
+
+    // matches sorted by distance, then by word
+    std::vector<FuzzyMatch> search(const std::string &_query, int _max_distance)
+    {
+        query = _query;
+        max_distance = _max_distance;
+        visited_nodes = 0;
+        int m = query.size();
+        // longer words are more than max_distance insertions away
+        rows.assign((m + max_distance + 1) * (m + 1), 0);
+        std::iota(rows.begin(), rows.begin() + m + 1, 0);
+
+        std::vector<FuzzyMatch> matches;
+        rec(matches, 0, 0);
+        // dfs order of the trie is lexicographic
+        std::stable_sort(matches.begin(), matches.end(), [](const FuzzyMatch &a, const FuzzyMatch &b)
+                         { return a.distance < b.distance; });
+        return matches;
+    }
+
+    void rec(std::vector<FuzzyMatch> &matches, int v, int depth)
+    {
+        visited_nodes++;
+        int m = query.size();
+        if (depth == m + max_distance)
+        {
+            return;
+        }
+        int *prev = &rows[depth * (m + 1)];
+        int *row = prev + m + 1;
+        for (auto &e : trie.graph.neighbors(v))
+        {
+            char c = e.get_letter();
+            row[0] = depth + 1;
+            int row_min = row[0];
+            for (int j = 1; j <= m; j++)
+            {
+                row[j] = std::min({prev[j] + 1, row[j - 1] + 1, prev[j - 1] + (query[j - 1] != c)});
+                row_min = std::min(row_min, row[j]);
+            }
+
+            // prune subtree
+            if (row_min > max_distance)
+            {
+                continue;
+            }
+            if (e.is_word() && row[m] <= max_distance)
+            {
+                matches.push_back({node_to_word_index[e.get_id()], row[m]});
+            }
+            rec(matches, e.get_id(), depth + 1);
+        }
+    }
+
+    int get_num_visited_nodes() { return visited_nodes; }
+
+    WordList &words;
+    StaticTrieGraph<EdgeType> trie;
+    PolicyVector<int> node_to_word_index;
+
+    std::string query;
+    int max_distance;
+    std::vector<int> rows;
+    int visited_nodes = 0;
+};
@@ -2,6 +2,11 @@
 
 #include <vector>
 #include <queue>
+#include <cassert>
+#include <numeric>
+#include <cstdint>
+
+#include "allocator.h"
 
 template <typename Iter>
 struct IteratorWrapper
@@ -18,6 +23,7 @@ struct IteratorWrapper
 template <typename EdgeType>
 struct AdjacencyList
 {
+    using Edge = EdgeType;
     using IteratorType = std::vector<EdgeType>::iterator;
 
     IteratorWrapper<IteratorType> neighbors(int v)
@@ -93,14 +99,83 @@ int compute_dfs_order_rec(Graph &graph, std::vector<int> &mapping, int id, int v
     return id;
 }
 
+std::vector<int> identity_order(int n)
+{
+    std::vector<int> order(n);
+    std::iota(order.begin(), order.end(), 0);
+    return order;
+}
+
+// a permutation of [0, n) that keeps the root 0 at id 0
+bool is_valid_node_order(std::vector<int> &order, int n)
+{
+    if ((int)order.size() != n || (n > 0 && order[0] != 0))
+    {
+        return false;
+    }
+    std::vector<bool> seen(n, false);
+    for (int id : order)
+    {
+        if (id < 0 || id >= n || seen[id])
+        {
+            return false;
+        }
+        seen[id] = true;
+    }
+    return true;
+}
+
+// result[v] = second[first[v]], i.e. first apply first and then second
+std::vector<int> compose_orders(std::vector<int> &first, std::vector<int> &second)
+{
+    std::vector<int> order(first.size());
+    for (uint v = 0; v < first.size(); v++)
+    {
+        order[v] = second[first[v]];
+    }
+    return order;
+}
+
+// nodes visited at least min_visits times get the smallest ids, the remaining nodes follow,
+// both groups keep their dfs order so that hot paths stay close to each other in memory
+template <typename Graph>
+std::vector<int> compute_profile_order(Graph &graph, std::vector<uint32_t> &visit_counts, int start_node, uint32_t min_visits = 1)
+{
+    int n = graph.num_nodes();
+    assert((int)visit_counts.size() == n);
+    std::vector<int> dfs_order = compute_dfs_order(graph, start_node);
+    std::vector<int> node_at(n);
+    for (int v = 0; v < n; v++)
+    {
+        node_at[dfs_order[v]] = v;
+    }
+
+    int id = 0;
+    std::vector<int> profile_order(n);
+    auto is_hot = [&](int v)
+    { return v == start_node || visit_counts[v] >= min_visits; };
+    for (int i = 0; i < n; i++)
+    {
+        if (is_hot(node_at[i]))
+            profile_order[node_at[i]] = id++;
+    }
+    for (int i = 0; i < n; i++)
+    {
+        if (!is_hot(node_at[i]))
+            profile_order[node_at[i]] = id++;
+    }
+    return profile_order;
+}
+
 template <typename EdgeType>
 struct AdjacencyArray
 {
-    using IteratorType = std::vector<EdgeType>::iterator;
+    using Edge = EdgeType;
+    using IteratorType = PolicyVector<EdgeType>::iterator;
 
     AdjacencyArray() {}
 
-    AdjacencyArray(AdjacencyList<EdgeType> &graph)
+    AdjacencyArray(AdjacencyList<EdgeType> &graph, MemoryPolicy policy = MemoryPolicy::DEFAULT_ALLOCATION) : nodes(PolicyAllocator<int>(policy)), edges(PolicyAllocator<EdgeType>(policy))
     {
         int n = graph.num_nodes();
         nodes.resize(n + 1);
@@ -122,18 +197,25 @@ struct AdjacencyArray
         }
     }
 
-    static AdjacencyArray construct_with_bfs_order(AdjacencyList<EdgeType> &graph)
+    static AdjacencyArray construct_with_bfs_order(AdjacencyList<EdgeType> &graph, MemoryPolicy policy = MemoryPolicy::DEFAULT_ALLOCATION)
     {
         auto order = compute_bfs_order(graph, 0);
         auto rearranged = remap_graph(graph, order);
-        return AdjacencyArray(rearranged);
+        return AdjacencyArray(rearranged, policy);
     }
 
-    static AdjacencyArray construct_with_dfs_order(AdjacencyList<EdgeType> &graph)
+    static AdjacencyArray construct_with_dfs_order(AdjacencyList<EdgeType> &graph, MemoryPolicy policy = MemoryPolicy::DEFAULT_ALLOCATION)
     {
         auto order = compute_dfs_order(graph, 0);
         auto rearranged = remap_graph(graph, order);
-        return AdjacencyArray(rearranged);
+        return AdjacencyArray(rearranged, policy);
+    }
+
+    static AdjacencyArray construct_with_order(AdjacencyList<EdgeType> &graph, std::vector<int> &order, MemoryPolicy policy = MemoryPolicy::DEFAULT_ALLOCATION)
+    {
+        assert((int)order.size() == graph.num_nodes());
+        auto rearranged = remap_graph(graph, order);
+        return AdjacencyArray(rearranged, policy);
     }
 
     inline int num_nodes() const { return nodes.size() - 1; }
@@ -146,6 +228,6 @@ struct AdjacencyArray
         return IteratorWrapper<IteratorType>(edges.begin() + start, edges.begin() + end);
     }
 
-    std::vector<int> nodes;
-    std::vector<EdgeType> edges;
+    PolicyVector<int> nodes;
+    PolicyVector<EdgeType> edges;
 };
\ No newline at end of file
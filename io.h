@@ -4,6 +4,8 @@
 #include <vector>
 #include <string>
 #include <fstream>
+#include <cstdint>
+#include <unordered_map>
 namespace io
 {
 
@@ -59,4 +61,82 @@ namespace io
         file.close();
         return words;
     }
-}
\ No newline at end of file
+
+    // binary format: number of nodes followed by the new id of each node
+    void write_node_order(std::string &path, std::vector<int> &order)
+    {
+        std::ofstream file(path, std::ios::binary);
+        if (!file.is_open())
+        {
+            std::cerr << "Error: Unable to open the file: " << path << std::endl;
+            exit(1);
+        }
+        uint64_t n = order.size();
+        file.write(reinterpret_cast<const char *>(&n), sizeof(n));
+        file.write(reinterpret_cast<const char *>(order.data()), n * sizeof(int));
+        file.close();
+    }
+
+    // the number of nodes has to match the file length, the graph builder checks the permutation
+    std::vector<int> read_node_order(std::string &path)
+    {
+        std::ifstream file(path, std::ios::binary | std::ios::ate);
+        std::vector<int> order;
+        if (!file.is_open())
+        {
+            std::cerr << "Error: Unable to open the file: " << path << std::endl;
+            exit(1);
+            return order;
+        }
+        uint64_t file_bytes = file.tellg();
+        file.seekg(0);
+        uint64_t n = 0;
+        file.read(reinterpret_cast<char *>(&n), sizeof(n));
+        if (!file || n != (file_bytes - sizeof(n)) / sizeof(int) || (file_bytes - sizeof(n)) % sizeof(int) != 0)
+        {
+            std::cerr << "Error: node order file does not match its size: " << path << std::endl;
+            exit(1);
+        }
+        order.resize(n);
+        file.read(reinterpret_cast<char *>(order.data()), n * sizeof(int));
+        if (!file)
+        {
+            std::cerr << "Error: node order file is truncated: " << path << std::endl;
+            exit(1);
+        }
+        file.close();
+        return order;
+    }
+
+    // text format: one "word weight" pair per line, words not in the dictionary are ignored
+    // and dictionary words without a line get weight 0
+    std::vector<float> read_word_weights(std::string &path, std::vector<std::string> &words)
+    {
+        std::ifstream file(path);
+        std::vector<float> weights(words.size(), 0.0f);
+        if (!file.is_open())
+        {
+            std::cerr << "Error: Unable to open the file: " << path << std::endl;
+            exit(1);
+            return weights;
+        }
+
+        std::unordered_map<std::string, int> word_index;
+        for (uint i = 0; i < words.size(); i++)
+        {
+            word_index[words[i]] = i;
+        }
+        std::string word;
+        float weight;
+        while (file >> word >> weight)
+        {
+            auto it = word_index.find(word);
+            if (it != word_index.end())
+            {
+                weights[it->second] = weight;
+            }
+        }
+        file.close();
+        return weights;
+    }
+}
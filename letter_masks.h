@@ -0,0 +1,112 @@
+#pragma once
+
+#include <string>
+#include <bit>
+#include <cstdint>
+#ifdef __AVX2__
+#include <immintrin.h>
+#endif
+
+#include "common.h"
+
+// bit l is set if letter l occurs in the word
+inline uint32_t letter_mask(const std::string &word)
+{
+    uint32_t mask = 0;
+    for (char c : word)
+    {
+        mask |= 1u << (c - 'a');
+    }
+    return mask;
+}
+
+// counts[l] is the number of masks with bit l, only the letters of active are counted, the others
+// are set to 0
+void count_letters(const uint32_t *masks, int n, uint32_t active, int counts[ALPHABET_SIZE])
+{
+    for (int l = 0; l < ALPHABET_SIZE; l++)
+    {
+        counts[l] = 0;
+        if (!(active >> l & 1))
+            continue;
+        int i = 0;
+#ifdef __AVX2__
+        // bit l moved to the sign bit of each of the 8 lanes
+        for (; i + 8 <= n; i += 8)
+        {
+            __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(masks + i));
+            __m256i sign = _mm256_sll_epi32(v, _mm_cvtsi32_si128(31 - l));
+            counts[l] += std::popcount((uint32_t)_mm256_movemask_ps(_mm256_castsi256_ps(sign)));
+        }
+#endif
+        for (; i < n; i++)
+        {
+            counts[l] += masks[i] >> l & 1;
+        }
+    }
+}
+
+// position of the mask with the highest sum of freq over its letters, ties go to the later
+// position; the sum adds the letters in increasing order like a scalar loop over the alphabet,
+// letters with freq 0 only add zeros and are left out
+int argmax_letter_score(const uint32_t *masks, int n, const double freq[ALPHABET_SIZE])
+{
+    int letters[ALPHABET_SIZE];
+    int num_letters = 0;
+    for (int l = 0; l < ALPHABET_SIZE; l++)
+    {
+        if (freq[l] != 0)
+        {
+            letters[num_letters++] = l;
+        }
+    }
+    double best_score = -1;
+    int best = -1;
+    int i = 0;
+#ifdef __AVX2__
+    __m256d best_scores = _mm256_set1_pd(-1);
+    __m256i best_positions = _mm256_set1_epi64x(-1);
+    __m256i positions = _mm256_setr_epi64x(0, 1, 2, 3);
+    for (; i + 4 <= n; i += 4)
+    {
+        __m256i m = _mm256_cvtepu32_epi64(_mm_loadu_si128(reinterpret_cast<const __m128i *>(masks + i)));
+        __m256d score = _mm256_setzero_pd();
+        for (int k = 0; k < num_letters; k++)
+        {
+            __m256i bit = _mm256_set1_epi64x(1ULL << letters[k]);
+            __m256i has_letter = _mm256_cmpeq_epi64(_mm256_and_si256(m, bit), bit);
+            score = _mm256_add_pd(score, _mm256_and_pd(_mm256_castsi256_pd(has_letter), _mm256_set1_pd(freq[letters[k]])));
+        }
+        __m256d better = _mm256_cmp_pd(score, best_scores, _CMP_GE_OQ);
+        best_scores = _mm256_blendv_pd(best_scores, score, better);
+        best_positions = _mm256_castpd_si256(_mm256_blendv_pd(_mm256_castsi256_pd(best_positions), _mm256_castsi256_pd(positions), better));
+        positions = _mm256_add_epi64(positions, _mm256_set1_epi64x(4));
+    }
+    double lane_scores[4];
+    int64_t lane_positions[4];
+    _mm256_storeu_pd(lane_scores, best_scores);
+    _mm256_storeu_si256(reinterpret_cast<__m256i *>(lane_positions), best_positions);
+    for (int k = 0; k < 4; k++)
+    {
+        if (lane_scores[k] > best_score || (lane_scores[k] == best_score && lane_positions[k] > best))
+        {
+            best_score = lane_scores[k];
+            best = lane_positions[k];
+        }
+    }
+#endif
+    for (; i < n; i++)
+    {
+        double score = 0;
+        for (int k = 0; k < num_letters; k++)
+        {
+            score += (masks[i] >> letters[k] & 1) ? freq[letters[k]] : 0.0;
+        }
+        if (score >= best_score)
+        {
+            best_score = score;
+            best = i;
+        }
+    }
+    return best;
+}
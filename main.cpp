@@ -16,18 +16,39 @@ void run_benchmarks()
 
     print_word_statistics(words);
 
+    benchmark_trie_construction(words);
+    benchmark_parallel_construction(words);
+
     benchmark_trie_by_word_length<Trie>(words, "Trie");
     benchmark_trie_by_word_length<TrieArray>(words, "TrieArray");
     benchmark_trie_by_word_length<StaticTrieGraph<TrieEdge>>(words, "StaticTrie");
     benchmark_trie_by_word_length<StaticTrieGraph<CompressedTrieEdge>>(words, "StaticTrie Compressed Edge");
+    benchmark_trie_by_word_length<PerfectHashWordSet>(words, "PerfectHash");
+
+    benchmark_batched_lookup_by_word_length<TrieArray>(words, "TrieArray");
+    benchmark_batched_lookup_by_word_length<StaticTrieGraph<TrieEdge>>(words, "StaticTrie");
+
+    benchmark_bloom_filter(words);
+    benchmark_prefix_completion(words);
+    benchmark_fuzzy_search(words);
+    benchmark_fm_index(words);
+    benchmark_pattern_search(words);
+    benchmark_feedback_matrix(words);
+    benchmark_feedback_kernel(words);
+    benchmark_decision_tree(words);
+    benchmark_opening_book(words);
 
     benchmark_word_challenge(words);
+    benchmark_memory_policy(words);
 
     GuesserStrategy strategy = GuesserStrategy::RANDOM_CANDITATE;
     benchmark_wordle(words, strategy);
+    benchmark_wordle(words, strategy, false, false, CandidateEngine::BITSET);
 
     strategy = GuesserStrategy::LETTER_FREQUENCY;
     benchmark_wordle(words, strategy);
+    benchmark_parallel_wordle(words, strategy);
+    benchmark_short_wordle_games(words);
 }
 
 int main(int argc, char *argv[])
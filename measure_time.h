@@ -19,4 +19,14 @@ int measureTimeMicroS(Function f)
     auto end = std::chrono::high_resolution_clock::now();
     auto duration = std::chrono::duration_cast<std::chrono::microseconds>(end - start);
     return duration.count();
+}
+// 64 bit, a single guess that builds a decision tree may take longer than 2^31 ns
+template <typename Function>
+long long measureTimeNanoS(Function f)
+{
+    auto start = std::chrono::high_resolution_clock::now();
+    f();
+    auto end = std::chrono::high_resolution_clock::now();
+    auto duration = std::chrono::duration_cast<std::chrono::nanoseconds>(end - start);
+    return duration.count();
 }
\ No newline at end of file
@@ -0,0 +1,325 @@
+#pragma once
+
+#include <vector>
+#include <string>
+#include <algorithm>
+#include <numeric>
+#include <tuple>
+#include <fstream>
+#include <iostream>
+#include <cmath>
+#include <cstdint>
+
+#include "common.h"
+#include "bloom_filter.h"
+#include "feedback.h"
+
+// first guess of every word length and second guess for every pattern of the first one, both
+// maximize the expected information over all words of the length
+struct OpeningBook
+{
+    static constexpr uint64_t FILE_MAGIC = 0x314b4f4f424c5257ULL;
+
+    struct Entry
+    {
+        uint32_t code;
+        int32_t guess;
+        uint32_t num_secrets;
+    };
+
+    static uint64_t hash_dictionary(WordList &words)
+    {
+        uint64_t h = words.size();
+        for (auto &w : words)
+        {
+            h = mix_hash(h ^ hash_string(w));
+        }
+        return h;
+    }
+
+    bool has_length(int length) const
+    {
+        return length < (int)first_guess.size() && first_guess[length] != -1;
+    }
+
+    // nullptr if no secret gives this pattern for the first guess
+    const Entry *find_second(int length, uint64_t code) const
+    {
+        auto &entries = second_guess[length];
+        auto it = std::lower_bound(entries.begin(), entries.end(), code, [](const Entry &e, uint64_t x)
+                                   { return e.code < x; });
+        return it != entries.end() && it->code == code ? &*it : nullptr;
+    }
+
+    void save(std::string &path)
+    {
+        std::ofstream file(path, std::ios::binary);
+        if (!file.is_open())
+        {
+            std::cerr << "Warning: Unable to write the opening book: " << path << std::endl;
+            return;
+        }
+        uint64_t header[3] = {FILE_MAGIC, dictionary_hash, first_guess.size()};
+        file.write(reinterpret_cast<const char *>(header), sizeof(header));
+        file.write(reinterpret_cast<const char *>(first_guess.data()), first_guess.size() * sizeof(int32_t));
+        for (auto &entries : second_guess)
+        {
+            uint64_t size = entries.size();
+            file.write(reinterpret_cast<const char *>(&size), sizeof(size));
+            file.write(reinterpret_cast<const char *>(entries.data()), entries.size() * sizeof(Entry));
+        }
+    }
+
+    // false if the file is missing, was built for another dictionary or is not a well formed book
+    bool load(std::string &path, WordList &words)
+    {
+        std::ifstream file(path, std::ios::binary | std::ios::ate);
+        uint64_t header[3];
+        if (!file.is_open())
+        {
+            return false;
+        }
+        // every size is checked against the bytes left before anything is allocated
+        uint64_t bytes_left = file.tellg();
+        file.seekg(0);
+        if (!file.read(reinterpret_cast<char *>(header), sizeof(header)))
+        {
+            return false;
+        }
+        if (header[0] != FILE_MAGIC || header[1] != hash_dictionary(words))
+        {
+            return false;
+        }
+        bytes_left -= sizeof(header);
+        // a first guess and an entry count per length
+        if (header[2] > bytes_left / (sizeof(int32_t) + sizeof(uint64_t)))
+        {
+            return false;
+        }
+        dictionary_hash = header[1];
+        first_guess.resize(header[2]);
+        second_guess.resize(header[2]);
+        file.read(reinterpret_cast<char *>(first_guess.data()), first_guess.size() * sizeof(int32_t));
+        bytes_left -= first_guess.size() * sizeof(int32_t);
+        bool valid = (bool)file;
+        for (auto &entries : second_guess)
+        {
+            uint64_t size = 0;
+            if (!valid || !file.read(reinterpret_cast<char *>(&size), sizeof(size)))
+            {
+                valid = false;
+                break;
+            }
+            bytes_left -= sizeof(size);
+            if (size > bytes_left / sizeof(Entry))
+            {
+                valid = false;
+                break;
+            }
+            entries.resize(size);
+            file.read(reinterpret_cast<char *>(entries.data()), entries.size() * sizeof(Entry));
+            bytes_left -= entries.size() * sizeof(Entry);
+        }
+        if (!valid || !file || bytes_left != 0 || !has_valid_guesses(words))
+        {
+            first_guess.clear();
+            second_guess.clear();
+            return false;
+        }
+        return true;
+    }
+
+    // first guesses are -1 or indices of words of their length, second guesses are indices of
+    // words of their length
+    bool has_valid_guesses(WordList &words) const
+    {
+        auto is_word_of_length = [&](int32_t g, size_t length)
+        { return g >= 0 && (size_t)g < words.size() && words[g].size() == length; };
+        for (size_t len = 0; len < first_guess.size(); len++)
+        {
+            if (first_guess[len] != -1 && !is_word_of_length(first_guess[len], len))
+            {
+                return false;
+            }
+            for (const Entry &e : second_guess[len])
+            {
+                if (!is_word_of_length(e.guess, len))
+                {
+                    return false;
+                }
+            }
+        }
+        return true;
+    }
+
+    size_t memory_bytes() const
+    {
+        size_t bytes = first_guess.size() * sizeof(int32_t);
+        for (auto &entries : second_guess)
+        {
+            bytes += entries.size() * sizeof(Entry);
+        }
+        return bytes;
+    }
+
+    uint64_t dictionary_hash = 0;
+    // -1 if the book has no word of this length
+    std::vector<int32_t> first_guess;
+    // sorted by code
+    std::vector<std::vector<Entry>> second_guess;
+};
+
+// offline construction of the book, every score is exact: each guess of the length is evaluated
+// against all secrets of the pattern class with batch_pattern_codes
+struct OpeningBookBuilder
+{
+    // 3^10, longer words count patterns by sorting
+    static constexpr uint64_t DENSE_HISTOGRAM_CODES = 59049;
+    static constexpr int GUESS_BLOCK_SIZE = 64;
+
+    OpeningBookBuilder(WordList &_words, int _num_threads = default_num_threads()) : words(_words), num_threads(_num_threads), scratch(std::max(1, _num_threads))
+    {
+        words_of_len = compute_index_word_of_len(words);
+        n_log_n.resize(words.size() + 1, 0);
+        for (uint c = 1; c <= words.size(); c++)
+        {
+            n_log_n[c] = c * std::log2(c);
+        }
+    }
+
+    // sum of c * log2(c) over the pattern classes of guess against the batch
+    double cost(std::string &guess, SecretBatch &batch, std::vector<uint32_t> &codes, std::vector<uint32_t> &histogram, bool dense)
+    {
+        batch_pattern_codes(guess, batch, codes.data());
+        double sum = 0;
+        if (dense)
+        {
+            for (int s = 0; s < batch.n; s++)
+            {
+                histogram[codes[s]]++;
+            }
+            for (int s = 0; s < batch.n; s++)
+            {
+                sum += n_log_n[histogram[codes[s]]];
+                histogram[codes[s]] = 0;
+            }
+            return sum;
+        }
+        std::sort(codes.begin(), codes.begin() + batch.n);
+        for (int i = 0, j = 0; i < batch.n; i = j)
+        {
+            while (j < batch.n && codes[j] == codes[i])
+                j++;
+            sum += n_log_n[j - i];
+        }
+        return sum;
+    }
+
+    // guess with the maximal expected information, ties prefer a possible secret, then the smaller
+    // index like compute_max_entropy_word; blocks of guesses run in parallel if parallel is set
+    // without parallel the buffers of the given worker are used
+    int best_guess(std::vector<int> &guesses, std::vector<int> &secrets, bool parallel, int worker = 0)
+    {
+        if (secrets.size() <= 2)
+        {
+            return *std::min_element(secrets.begin(), secrets.end());
+        }
+        int length = words[secrets[0]].size();
+        SecretBatch batch(words, secrets);
+        int num_guesses = guesses.size();
+        std::vector<double> costs(num_guesses);
+        auto run_block = [&](int b, int w)
+        {
+            // entries are cleared again by cost
+            auto &[codes, histogram] = scratch[parallel ? w : worker];
+            bool dense = num_pattern_codes(length) <= DENSE_HISTOGRAM_CODES;
+            codes.resize(batch.stride);
+            histogram.resize(std::max<size_t>(histogram.size(), dense ? num_pattern_codes(length) : 0), 0);
+            int end = std::min(num_guesses, (b + 1) * GUESS_BLOCK_SIZE);
+            for (int i = b * GUESS_BLOCK_SIZE; i < end; i++)
+            {
+                costs[i] = cost(words[guesses[i]], batch, codes, histogram, dense);
+            }
+        };
+        int num_blocks = (num_guesses + GUESS_BLOCK_SIZE - 1) / GUESS_BLOCK_SIZE;
+        parallel_for_each(num_blocks, parallel ? num_threads : 1, run_block);
+
+        std::vector<bool> is_secret(words.size(), false);
+        for (int s : secrets)
+        {
+            is_secret[s] = true;
+        }
+        int best = 0;
+        for (int i = 1; i < num_guesses; i++)
+        {
+            auto key = [&](int j)
+            { return std::make_tuple(costs[j], !is_secret[guesses[j]], guesses[j]); };
+            if (key(i) < key(best))
+            {
+                best = i;
+            }
+        }
+        return guesses[best];
+    }
+
+    // lengths longer than max_length are left out
+    OpeningBook build(int max_length = MAX_BATCH_LENGTH)
+    {
+        OpeningBook book;
+        book.dictionary_hash = OpeningBook::hash_dictionary(words);
+        int num_lengths = std::min<int>(words_of_len.size(), max_length + 1);
+        book.first_guess.assign(num_lengths, -1);
+        book.second_guess.resize(num_lengths);
+        for (int len = 1; len < num_lengths; len++)
+        {
+            auto &all = words_of_len[len];
+            if (all.empty())
+                continue;
+            int first = best_guess(all, all, true);
+            book.first_guess[len] = first;
+
+            // secrets grouped by the pattern of the first guess
+            std::vector<std::pair<uint64_t, int>> coded;
+            for (int s : all)
+            {
+                coded.push_back({pattern_code(words[first], words[s]), s});
+            }
+            std::sort(coded.begin(), coded.end());
+            std::vector<std::pair<uint64_t, std::vector<int>>> classes;
+            for (auto [code, s] : coded)
+            {
+                if (classes.empty() || classes.back().first != code)
+                {
+                    classes.push_back({code, {}});
+                }
+                classes.back().second.push_back(s);
+            }
+
+            // largest classes first for the load balance
+            std::vector<int> order(classes.size());
+            std::iota(order.begin(), order.end(), 0);
+            std::stable_sort(order.begin(), order.end(), [&](int a, int b)
+                             { return classes[a].second.size() > classes[b].second.size(); });
+            auto &entries = book.second_guess[len];
+            entries.resize(classes.size());
+            parallel_for_each(classes.size(), num_threads, [&](int t, int w)
+                              {
+                int c = order[t];
+                auto &[code, secrets] = classes[c];
+                entries[c] = {(uint32_t)code, best_guess(all, secrets, false, w), (uint32_t)secrets.size()}; });
+        }
+        return book;
+    }
+
+    WordList &words;
+    int num_threads;
+    // pattern codes and histogram of each worker thread
+    struct Scratch
+    {
+        std::vector<uint32_t> codes;
+        std::vector<uint32_t> histogram;
+    };
+    std::vector<Scratch> scratch;
+    std::vector<std::vector<int>> words_of_len;
+    std::vector<double> n_log_n;
+};
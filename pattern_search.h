@@ -0,0 +1,283 @@
+#pragma once
+
+#include <vector>
+#include <string>
+#include <array>
+#include <bit>
+#include <cstdint>
+
+#include "common.h"
+#include "static_trie.h"
+#include "concepts.h"
+
+// crossword style pattern, e.g. "c?t*", "[aeiou]..e." or "..... -s +r"
+//
+//   a         the letter a
+//   . or ?    any letter
+//   *         any number of letters
+//   [abc]     one of the letters, ranges like [a-e] are allowed
+//   [^abc]    any letter except these
+//   +ab       the word contains a and b, repeat a letter to require it more often
+//   -ab       the word contains neither a nor b
+//
+// the letter part is matched by a bit parallel NFA: bit i of the state is set if the first i
+// elements match the prefix read so far, so a single shift per letter advances all of them
+struct PatternQuery
+{
+    static constexpr int MAX_ELEMENTS = 63;
+    static constexpr uint32_t ALL_LETTERS = (1u << 26) - 1;
+    static constexpr int NO_LIMIT = 1 << 30;
+
+    bool parse(const std::string &pattern)
+    {
+        std::vector<uint32_t> elements;
+        star = 0;
+        min_count.fill(0);
+        max_count.fill(NO_LIMIT);
+        error = "";
+
+        uint i = 0;
+        while (i < pattern.size() && pattern[i] != ' ')
+        {
+            char c = pattern[i];
+            if (c == '*')
+            {
+                star |= 1ULL << elements.size();
+                elements.push_back(ALL_LETTERS);
+                i++;
+            }
+            else if (c == '.' || c == '?')
+            {
+                elements.push_back(ALL_LETTERS);
+                i++;
+            }
+            else if (c >= 'a' && c <= 'z')
+            {
+                elements.push_back(1u << (c - 'a'));
+                i++;
+            }
+            else if (c == '[')
+            {
+                uint32_t mask = 0;
+                if (!parse_letter_set(pattern, i, mask))
+                {
+                    return false;
+                }
+                elements.push_back(mask);
+            }
+            else
+            {
+                error = std::string("unexpected character ") + c;
+                return false;
+            }
+            if (elements.size() > MAX_ELEMENTS)
+            {
+                error = "pattern has more than " + std::to_string(MAX_ELEMENTS) + " elements";
+                return false;
+            }
+        }
+
+        while (i < pattern.size())
+        {
+            if (pattern[i] == ' ')
+            {
+                i++;
+                continue;
+            }
+            char sign = pattern[i++];
+            if ((sign != '+' && sign != '-') || i == pattern.size() || pattern[i] < 'a' || pattern[i] > 'z')
+            {
+                error = "constraints look like +abc or -abc";
+                return false;
+            }
+            for (; i < pattern.size() && pattern[i] >= 'a' && pattern[i] <= 'z'; i++)
+            {
+                int l = pattern[i] - 'a';
+                if (sign == '+')
+                    min_count[l]++;
+                else
+                    max_count[l] = 0;
+            }
+        }
+
+        num_elements = elements.size();
+        min_length = num_elements - std::popcount(star);
+        total_min_count = 0;
+        for (int l = 0; l < 26; l++)
+        {
+            total_min_count += min_count[l];
+        }
+        for (int l = 0; l < 26; l++)
+        {
+            accepts[l] = 0;
+            for (int e = 0; e < num_elements; e++)
+            {
+                if (elements[e] & (1u << l))
+                {
+                    accepts[l] |= 1ULL << e;
+                }
+            }
+        }
+        return true;
+    }
+
+    bool parse_letter_set(const std::string &pattern, uint &i, uint32_t &mask)
+    {
+        // skip [
+        i++;
+        bool negated = i < pattern.size() && pattern[i] == '^';
+        if (negated)
+            i++;
+        while (i < pattern.size() && pattern[i] != ']')
+        {
+            char from = pattern[i];
+            char to = from;
+            if (i + 2 < pattern.size() && pattern[i + 1] == '-' && pattern[i + 2] != ']')
+            {
+                to = pattern[i + 2];
+                i += 2;
+            }
+            if (from < 'a' || to > 'z' || from > to)
+            {
+                error = "letter sets may only contain letters and ranges like a-e";
+                return false;
+            }
+            for (char c = from; c <= to; c++)
+            {
+                mask |= 1u << (c - 'a');
+            }
+            i++;
+        }
+        if (i == pattern.size())
+        {
+            error = "missing ]";
+            return false;
+        }
+        // skip ]
+        i++;
+        if (negated)
+            mask = ~mask & ALL_LETTERS;
+        return true;
+    }
+
+    // a star element may also be skipped
+    inline uint64_t closure(uint64_t state) const
+    {
+        while (true)
+        {
+            uint64_t next = state | ((state & star) << 1);
+            if (next == state)
+                return state;
+            state = next;
+        }
+    }
+
+    inline uint64_t start_state() const { return closure(1); }
+
+    inline uint64_t step(uint64_t state, char c) const
+    {
+        uint64_t matched = state & accepts[c - 'a'];
+        return closure(((matched & ~star) << 1) | (matched & star));
+    }
+
+    inline bool is_accepting(uint64_t state) const { return state >> num_elements & 1; }
+
+    // reference for the trie search
+    bool matches(const std::string &word) const
+    {
+        uint64_t state = start_state();
+        std::array<int, 26> count{};
+        for (char c : word)
+        {
+            state = step(state, c);
+            count[c - 'a']++;
+        }
+        for (int l = 0; l < 26; l++)
+        {
+            if (count[l] < min_count[l] || count[l] > max_count[l])
+            {
+                return false;
+            }
+        }
+        return is_accepting(state);
+    }
+
+    bool has_star() const { return star != 0; }
+
+    // per element of the pattern
+    std::array<uint64_t, 26> accepts;
+    uint64_t star;
+    int num_elements;
+    int min_length;
+
+    std::array<int, 26> min_count;
+    std::array<int, 26> max_count;
+    int total_min_count;
+
+    std::string error;
+};
+
+// evaluates a PatternQuery by a trie traversal that stops as soon as the NFA state is empty,
+// a letter exceeds its maximal count or the remaining letters cannot contain all required ones
+template <TraversableTrieGraph Graph>
+struct BasicPatternSearch
+{
+    BasicPatternSearch(WordList &_words) : words(_words)
+    {
+        std::vector<int> node_order;
+        graph = build_trie_graph<Graph>(words, node_order);
+        node_to_word_index = construct_node_to_word_index(graph, words);
+    }
+
+    // word ids in lexicographic order
+    std::vector<int> search(const PatternQuery &_query)
+    {
+        query = &_query;
+        visited_nodes = 0;
+        count.fill(0);
+        std::vector<int> result;
+        rec(result, 0, 0, query->start_state(), query->total_min_count);
+        return result;
+    }
+
+    void rec(std::vector<int> &result, int v, int depth, uint64_t state, int missing)
+    {
+        visited_nodes++;
+        for (auto &e : graph.neighbors(v))
+        {
+            char c = e.get_letter();
+            int l = c - 'a';
+            uint64_t next = query->step(state, c);
+            // prune subtree
+            if (next == 0 || count[l] == query->max_count[l])
+            {
+                continue;
+            }
+            int next_missing = missing - (count[l] < query->min_count[l]);
+            if (!query->has_star() && next_missing > query->min_length - depth - 1)
+            {
+                continue;
+            }
+
+            count[l]++;
+            if (e.is_word() && next_missing == 0 && query->is_accepting(next))
+            {
+                result.push_back(node_to_word_index[e.get_id()]);
+            }
+            rec(result, e.get_id(), depth + 1, next, next_missing);
+            count[l]--;
+        }
+    }
+
+    int get_num_visited_nodes() { return visited_nodes; }
+
+    WordList &words;
+    Graph graph;
+    PolicyVector<int> node_to_word_index;
+
+    const PatternQuery *query;
+    std::array<int, 26> count;
+    int visited_nodes = 0;
+};
+
+using PatternSearch = BasicPatternSearch<AdjacencyArray<CompressedTrieEdge>>;
@@ -0,0 +1,202 @@
+#pragma once
+
+#include <vector>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <atomic>
+#include <bit>
+#include <cstdint>
+
+#include "common.h"
+#include "bloom_filter.h"
+
+// exact membership without prefix structure: a minimal perfect hash maps every word to its own
+// slot that stores a 16 bit fingerprint and the word id, hits are verified against the word list
+//
+// the hash function is built like BBHash: on each level the remaining keys are hashed into a bit
+// array of GAMMA bits per key, keys that do not collide with another key keep their bit and all
+// others move on to the next level, the slot of a key is the rank of its bit over all levels
+struct PerfectHashWordSet
+{
+    static constexpr double GAMMA = 2.0;
+    static constexpr int MAX_LEVELS = 32;
+
+    struct Level
+    {
+        std::vector<uint64_t> bits;
+        // number of set bits before each 64 bit word over all levels
+        std::vector<uint32_t> ranks;
+        uint64_t seed;
+    };
+
+    PerfectHashWordSet(WordList &_words) : PerfectHashWordSet(_words, default_num_threads()) {}
+
+    PerfectHashWordSet(WordList &_words, int num_threads) : words(_words)
+    {
+        int n = words.size();
+        std::vector<uint64_t> hashes(n);
+        parallel_for_blocks(n, num_threads, [&](int begin, int end)
+                            {
+            for (int i = begin; i < end; i++)
+            {
+                hashes[i] = hash_string(words[i]);
+            } });
+
+        std::vector<int> keys(n);
+        std::iota(keys.begin(), keys.end(), 0);
+        uint32_t rank = 0;
+        for (int l = 0; l < MAX_LEVELS && !keys.empty(); l++)
+        {
+            keys = build_level(keys, hashes, num_threads, rank);
+        }
+
+        // keys that collided on every level, practically only words with equal 64 bit hashes; a
+        // word that occurs several times gets one slot, which only its first occurrence writes
+        std::vector<bool> duplicate(n, false);
+        for (int i : keys)
+        {
+            auto [it, inserted] = fallback.try_emplace(words[i], rank);
+            if (inserted)
+            {
+                rank++;
+            }
+            else
+            {
+                duplicate[i] = true;
+            }
+        }
+
+        fingerprints.resize(rank);
+        word_ids.resize(rank);
+        parallel_for_blocks(n, num_threads, [&](int begin, int end)
+                            {
+            for (int i = begin; i < end; i++)
+            {
+                if (duplicate[i])
+                    continue;
+                uint32_t slot = lookup_slot(words[i], hashes[i]);
+                fingerprints[slot] = fingerprint(hashes[i]);
+                word_ids[slot] = i;
+            } });
+    }
+
+    // calls f(begin, end) for about equal sized ranges of [0, n) on num_threads threads
+    template <typename Function>
+    static void parallel_for_blocks(int n, int num_threads, Function f)
+    {
+        int num_blocks = std::max(1, std::min(num_threads, n / 4096));
+        parallel_for_each(num_blocks, num_threads, [&](int b)
+                          { f((long long)n * b / num_blocks, (long long)n * (b + 1) / num_blocks); });
+    }
+
+    // returns the keys that collided on this level
+    std::vector<int> build_level(std::vector<int> &keys, std::vector<uint64_t> &hashes, int num_threads, uint32_t &rank)
+    {
+        Level level;
+        level.seed = mix_hash(levels.size() + 1);
+        size_t num_bits = std::max<size_t>(64, keys.size() * GAMMA);
+        size_t num_words = (num_bits + 63) / 64;
+        num_bits = num_words * 64;
+
+        std::vector<std::atomic<uint64_t>> seen(num_words);
+        std::vector<std::atomic<uint64_t>> collision(num_words);
+        int n = keys.size();
+        parallel_for_blocks(n, num_threads, [&](int begin, int end)
+                            {
+            for (int i = begin; i < end; i++)
+            {
+                uint64_t pos = level_position(hashes[keys[i]], level.seed, num_bits);
+                uint64_t mask = 1ULL << (pos % 64);
+                if (seen[pos / 64].fetch_or(mask, std::memory_order_relaxed) & mask)
+                {
+                    collision[pos / 64].fetch_or(mask, std::memory_order_relaxed);
+                }
+            } });
+
+        level.bits.resize(num_words);
+        level.ranks.resize(num_words);
+        for (size_t w = 0; w < num_words; w++)
+        {
+            level.bits[w] = seen[w].load() & ~collision[w].load();
+            level.ranks[w] = rank;
+            rank += std::popcount(level.bits[w]);
+        }
+
+        std::vector<int> remaining;
+        for (int k : keys)
+        {
+            uint64_t pos = level_position(hashes[k], level.seed, num_bits);
+            if (!(level.bits[pos / 64] & (1ULL << (pos % 64))))
+            {
+                remaining.push_back(k);
+            }
+        }
+        levels.push_back(std::move(level));
+        return remaining;
+    }
+
+    static inline uint64_t level_position(uint64_t hash, uint64_t seed, uint64_t num_bits)
+    {
+        return (uint64_t)(((unsigned __int128)mix_hash(hash ^ seed) * num_bits) >> 64);
+    }
+
+    static inline uint16_t fingerprint(uint64_t hash)
+    {
+        return hash >> 48;
+    }
+
+    // slot of a word in the set, any slot for other strings
+    inline uint32_t lookup_slot(std::string_view s, uint64_t hash) const
+    {
+        for (auto &level : levels)
+        {
+            uint64_t pos = level_position(hash, level.seed, level.bits.size() * 64);
+            uint64_t word = level.bits[pos / 64];
+            uint64_t mask = 1ULL << (pos % 64);
+            if (word & mask)
+            {
+                return level.ranks[pos / 64] + std::popcount(word & (mask - 1));
+            }
+        }
+        if (fallback.empty())
+        {
+            return 0;
+        }
+        auto it = fallback.find(std::string(s));
+        return it == fallback.end() ? 0 : it->second;
+    }
+
+    bool contains_word(std::string_view s) const
+    {
+        if (word_ids.empty())
+        {
+            return false;
+        }
+        uint64_t hash = hash_string(s);
+        uint32_t slot = lookup_slot(s, hash);
+        return fingerprints[slot] == fingerprint(hash) && words[word_ids[slot]] == s;
+    }
+
+    bool contains_word(std::string &s) const
+    {
+        return contains_word(std::string_view(s));
+    }
+
+    // excluding the word list, which is needed to verify hits
+    size_t memory_bytes() const
+    {
+        size_t bytes = fingerprints.size() * sizeof(uint16_t) + word_ids.size() * sizeof(uint32_t);
+        for (auto &level : levels)
+        {
+            bytes += level.bits.size() * sizeof(uint64_t) + level.ranks.size() * sizeof(uint32_t);
+        }
+        return bytes;
+    }
+
+    WordList &words;
+    std::vector<Level> levels;
+    std::unordered_map<std::string, uint32_t> fallback;
+    std::vector<uint16_t> fingerprints;
+    std::vector<uint32_t> word_ids;
+};
@@ -0,0 +1,179 @@
+#pragma once
+
+#include <vector>
+#include <string>
+#include <string_view>
+#include <queue>
+#include <algorithm>
+
+#include "common.h"
+#include "static_trie.h"
+
+// top-k completions of a prefix ranked by a per-word weight, ties are broken lexicographically
+//
+// every node stores the maximum weight in its subtree and its children are ranked by that bound,
+// a best-first search from the prefix node only pushes the best child and the next sibling of a
+// popped subtree, so it touches O(k * depth) nodes independent of the size of the dictionary
+struct PrefixCompleter
+{
+    using EdgeType = CompressedTrieEdge;
+
+    // all words weigh the same, completions come out in lexicographic order
+    PrefixCompleter(WordList &words) : PrefixCompleter(words, std::vector<float>(words.size(), 1.0f)) {}
+
+    PrefixCompleter(WordList &_words, std::vector<float> &&_weights) : words(_words), trie(_words), weights(std::move(_weights))
+    {
+        assert(weights.size() == words.size());
+        node_to_word_index = trie.construct_node_to_word_index(words);
+        compute_subtree_max_weights();
+    }
+
+    void compute_subtree_max_weights()
+    {
+        auto &graph = trie.graph;
+        int n = graph.num_nodes();
+        subtree_max_weight.assign(n, NO_WEIGHT);
+        // children have larger ids in dfs order
+        for (int v = n - 1; v >= 0; v--)
+        {
+            float w = node_to_word_index[v] == -1 ? NO_WEIGHT : weights[node_to_word_index[v]];
+            for (auto &e : graph.neighbors(v))
+            {
+                w = std::max(w, subtree_max_weight[e.get_id()]);
+            }
+            subtree_max_weight[v] = w;
+        }
+
+        // same offsets as the edges of the graph, children sorted by descending bound
+        ranked_children.resize(graph.edges.size());
+        for (int v = 0; v < n; v++)
+        {
+            int begin = graph.nodes[v];
+            int end = graph.nodes[v + 1];
+            for (int i = begin; i < end; i++)
+            {
+                ranked_children[i] = graph.edges[i].get_id();
+            }
+            std::sort(ranked_children.begin() + begin, ranked_children.begin() + end, [&](int a, int b)
+                      { return subtree_max_weight[a] != subtree_max_weight[b] ? subtree_max_weight[a] > subtree_max_weight[b] : a < b; });
+        }
+    }
+
+    // node reached by the prefix or -1
+    int find_prefix_node(std::string_view prefix)
+    {
+        int v = 0;
+        for (char c : prefix)
+        {
+            int next = -1;
+            for (auto &e : trie.graph.neighbors(v))
+            {
+                if (e.get_letter() == c)
+                {
+                    next = e.get_id();
+                    break;
+                }
+            }
+            if (next == -1)
+            {
+                return -1;
+            }
+            v = next;
+        }
+        return v;
+    }
+
+    // word ids of the k heaviest words starting with prefix, word_length = 0 allows every length
+    std::vector<int> complete(std::string_view prefix, int k, uint word_length = 0)
+    {
+        std::vector<int> result;
+        int start = find_prefix_node(prefix);
+        if (start == -1 || k <= 0 || (word_length > 0 && prefix.size() > word_length))
+        {
+            return result;
+        }
+
+        // a node item stands for its whole subtree and the subtrees of its later ranked siblings,
+        // a word item for the word ending at the node
+        struct Item
+        {
+            float weight;
+            int node;
+            // position of node in ranked_children and end of its siblings
+            int rank;
+            int rank_end;
+            uint depth;
+            bool is_word;
+
+            bool operator<(const Item &other) const
+            {
+                // max heap on weight, then smaller node id, i.e. lexicographically smaller, first
+                if (weight != other.weight)
+                    return weight < other.weight;
+                if (node != other.node)
+                    return node > other.node;
+                return !is_word && other.is_word;
+            }
+        };
+
+        auto &graph = trie.graph;
+        auto push_child = [&](std::priority_queue<Item> &queue, int rank, int rank_end, uint depth)
+        {
+            int v = ranked_children[rank];
+            queue.push({subtree_max_weight[v], v, rank, rank_end, depth, false});
+        };
+
+        std::priority_queue<Item> queue;
+        queue.push({subtree_max_weight[start], start, 0, 0, (uint)prefix.size(), false});
+        visited_nodes = 0;
+        while (!queue.empty() && (int)result.size() < k)
+        {
+            Item item = queue.top();
+            queue.pop();
+            visited_nodes++;
+            if (item.is_word)
+            {
+                result.push_back(node_to_word_index[item.node]);
+                continue;
+            }
+            if (item.rank + 1 < item.rank_end)
+            {
+                push_child(queue, item.rank + 1, item.rank_end, item.depth);
+            }
+            int word_index = node_to_word_index[item.node];
+            if (word_index != -1 && (word_length == 0 || item.depth == word_length))
+            {
+                queue.push({weights[word_index], item.node, 0, 0, item.depth, true});
+            }
+            int begin = graph.nodes[item.node];
+            int end = graph.nodes[item.node + 1];
+            if (begin < end && (word_length == 0 || item.depth < word_length))
+            {
+                push_child(queue, begin, end, item.depth + 1);
+            }
+        }
+        return result;
+    }
+
+    WordList complete_words(std::string_view prefix, int k, uint word_length = 0)
+    {
+        WordList completions;
+        for (int i : complete(prefix, k, word_length))
+        {
+            completions.push_back(words[i]);
+        }
+        return completions;
+    }
+
+    int get_num_visited_nodes() { return visited_nodes; }
+
+    static constexpr float NO_WEIGHT = -1e30f;
+
+    WordList &words;
+    StaticTrieGraph<EdgeType> trie;
+    std::vector<float> weights;
+    PolicyVector<int> node_to_word_index;
+    std::vector<float> subtree_max_weight;
+    std::vector<int> ranked_children;
+    int visited_nodes = 0;
+};
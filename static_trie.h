@@ -4,56 +4,220 @@
 #include <string>
 #include <cassert>
 #include <cstdint>
+#include <thread>
+#include <atomic>
+#include <algorithm>
+#include <span>
+#include <string_view>
 
 #include "common.h"
 #include "graph.h"
 #include "trie.h"
+#include "concepts.h"
+
+// builds the same graph as AdjacencyArray::construct_with_dfs_order on the trie of words:
+// words are partitioned by first letter, each subtree is built and dfs ordered independently
+// and the chunks are concatenated under the root with node and edge offsets
+template <typename EdgeType>
+AdjacencyArray<EdgeType> build_dfs_trie_graph_parallel(WordList &words, int num_threads, MemoryPolicy policy = MemoryPolicy::DEFAULT_ALLOCATION)
+{
+    // children of the root are sorted by char
+    std::vector<std::vector<std::string>> suffixes(256);
+    std::vector<bool> letter_is_word(256, false);
+    for (auto &s : words)
+    {
+        if (s.empty())
+            continue;
+        int bucket = (int)s[0] + 128;
+        if (s.size() == 1)
+        {
+            letter_is_word[bucket] = true;
+        }
+        suffixes[bucket].push_back(s.substr(1));
+    }
+    std::vector<int> buckets;
+    for (int b = 0; b < 256; b++)
+    {
+        if (!suffixes[b].empty())
+            buckets.push_back(b);
+    }
+    int k = buckets.size();
+
+    // largest partitions first for better load balance
+    std::vector<int> tasks(k);
+    std::iota(tasks.begin(), tasks.end(), 0);
+    std::sort(tasks.begin(), tasks.end(), [&](int i, int j)
+              { return suffixes[buckets[i]].size() > suffixes[buckets[j]].size(); });
+
+    std::vector<AdjacencyArray<EdgeType>> chunks(k);
+    parallel_for_each(k, num_threads, [&](int t)
+                      {
+        int i = tasks[t];
+        TrieArena trie(suffixes[buckets[i]]);
+        AdjacencyList<EdgeType> adj_list = trie.extract_graph<EdgeType>();
+        trie.release();
+        chunks[i] = AdjacencyArray<EdgeType>::construct_with_dfs_order(adj_list); });
+
+    std::vector<int> node_offset(k + 1, 1);
+    std::vector<int> edge_offset(k + 1, k);
+    for (int i = 0; i < k; i++)
+    {
+        node_offset[i + 1] = node_offset[i] + chunks[i].num_nodes();
+        edge_offset[i + 1] = edge_offset[i] + chunks[i].num_edges();
+    }
+
+    AdjacencyArray<EdgeType> graph;
+    graph.nodes = PolicyVector<int>(node_offset[k] + 1, 0, PolicyAllocator<int>(policy));
+    graph.edges = PolicyVector<EdgeType>(edge_offset[k], EdgeType(), PolicyAllocator<EdgeType>(policy));
+    graph.nodes[1] = k;
+    for (int i = 0; i < k; i++)
+    {
+        char letter = (char)(buckets[i] - 128);
+        graph.edges[i] = EdgeType(node_offset[i], letter, letter_is_word[buckets[i]]);
+    }
+    parallel_for_each(k, num_threads, [&](int i)
+                      {
+        auto &chunk = chunks[i];
+        // the end of the chunk is the start of the next one, written by another thread
+        for (int v = 0; v < chunk.num_nodes(); v++)
+        {
+            graph.nodes[node_offset[i] + v] = edge_offset[i] + chunk.nodes[v];
+        }
+        for (int j = 0; j < chunk.num_edges(); j++)
+        {
+            EdgeType e = chunk.edges[j];
+            e.set_id(e.get_id() + node_offset[i]);
+            graph.edges[edge_offset[i] + j] = e;
+        }
+        chunk = AdjacencyArray<EdgeType>(); });
+    graph.nodes[node_offset[k]] = edge_offset[k];
+    return graph;
+}
+
+// node order of the graph built by build_dfs_trie_graph_parallel relative to the trie of words
+std::vector<int> compute_trie_dfs_order(WordList &words)
+{
+    TrieArena trie(words);
+    AdjacencyList<TrieEdge> adj_list = trie.extract_graph<TrieEdge>();
+    trie.release();
+    return compute_dfs_order(adj_list, 0);
+}
+
+template <typename T>
+struct is_adjacency_array : std::false_type
+{
+};
+
+template <typename EdgeType>
+struct is_adjacency_array<AdjacencyArray<EdgeType>> : std::true_type
+{
+};
+
+// graph of the trie of words with the given node order relative to the trie, dfs order if it is empty;
+// with insertion_order an empty node order is set to the identity, nodes keep the trie order then
+template <TraversableTrieGraph Graph>
+Graph build_trie_graph(WordList &words, std::vector<int> &node_order, MemoryPolicy policy = MemoryPolicy::DEFAULT_ALLOCATION, bool insertion_order = false)
+{
+    using EdgeType = Graph::Edge;
+    if constexpr (is_adjacency_array<Graph>::value)
+    {
+        if (node_order.empty() && !insertion_order)
+        {
+            return build_dfs_trie_graph_parallel<EdgeType>(words, default_num_threads(), policy);
+        }
+    }
+    TrieArena trie(words);
+    AdjacencyList<EdgeType> adj_list = trie.extract_graph<EdgeType>();
+    trie.release();
+    if (node_order.empty() && insertion_order)
+    {
+        node_order = identity_order(adj_list.num_nodes());
+    }
+    std::vector<int> order = node_order.empty() ? compute_dfs_order(adj_list, 0) : node_order;
+    if ((int)order.size() != adj_list.num_nodes())
+    {
+        std::cerr << "Error: node order has " << order.size() << " nodes, but trie has " << adj_list.num_nodes() << "\n";
+        exit(1);
+    }
+    if (!is_valid_node_order(order, adj_list.num_nodes()))
+    {
+        std::cerr << "Error: node order is not a permutation of the trie nodes with the root first\n";
+        exit(1);
+    }
+    if constexpr (is_adjacency_array<Graph>::value)
+    {
+        return AdjacencyArray<EdgeType>::construct_with_order(adj_list, order, policy);
+    }
+    else
+    {
+        return remap_graph(adj_list, order);
+    }
+}
+
+// assumes trie constains word
+template <TraversableTrieGraph Graph>
+int find_trie_node(Graph &graph, std::string &s)
+{
+    int v = 0;
+    for (char c : s)
+    {
+        for (auto &e : graph.neighbors(v))
+        {
+            char l = e.get_letter();
+            if (l == c)
+            {
+                v = e.get_id();
+                break;
+            }
+        }
+    }
+    return v;
+}
+
+template <TraversableTrieGraph Graph>
+PolicyVector<int> construct_node_to_word_index(Graph &graph, WordList &words, MemoryPolicy policy = MemoryPolicy::DEFAULT_ALLOCATION)
+{
+    PolicyVector<int> node_to_word_index(graph.num_nodes(), -1, PolicyAllocator<int>(policy));
+    for (uint i = 0; i < words.size(); i++)
+    {
+        int v = find_trie_node(graph, words[i]);
+        assert(v > 0);
+        node_to_word_index[v] = i;
+    }
+    return node_to_word_index;
+}
 
 template <typename EdgeType>
 struct StaticTrieGraph
 {
     StaticTrieGraph(WordList &words)
     {
-        Trie trie(words);
+        TrieArena trie(words);
         AdjacencyList<EdgeType> adj_list = trie.extract_graph<EdgeType>();
+        trie.release();
         graph = AdjacencyArray<EdgeType>::construct_with_dfs_order(adj_list);
     }
 
+    StaticTrieGraph(WordList &words, int num_threads)
+    {
+        graph = build_dfs_trie_graph_parallel<EdgeType>(words, num_threads);
+    }
+
     // use same order as in adj_list
     StaticTrieGraph(AdjacencyArray<EdgeType> &adj_array)
     {
         graph = adj_array;
     }
 
-    std::vector<int> construct_node_to_word_index(WordList &words)
+    PolicyVector<int> construct_node_to_word_index(WordList &words, MemoryPolicy policy = MemoryPolicy::DEFAULT_ALLOCATION)
     {
-        std::vector<int> node_to_word_index(graph.num_nodes(), -1);
-        for (uint i = 0; i < words.size(); i++)
-        {
-            int v = find_node(words[i]);
-            assert(v > 0);
-            node_to_word_index[v] = i;
-        }
-        return node_to_word_index;
+        return ::construct_node_to_word_index(graph, words, policy);
     }
 
     // assumes trie constains word
     int find_node(std::string &s)
     {
-        uint32_t v = 0;
-        for (char c : s)
-        {
-            for (auto &e : graph.neighbors(v))
-            {
-                char l = e.get_letter();
-                if (l == c)
-                {
-                    v = e.get_id();
-                    break;
-                }
-            }
-        }
-        return v;
+        return find_trie_node(graph, s);
     }
 
     bool contains_word(std::string &s)
@@ -82,5 +246,101 @@ struct StaticTrieGraph
         return is_a_word;
     }
 
+    size_t memory_bytes() const
+    {
+        return graph.nodes.capacity() * sizeof(int) + graph.edges.capacity() * sizeof(EdgeType);
+    }
+
+    // AMAC style batch lookup: a group of lookups is advanced round robin, each step only
+    // prefetches the memory the lookup needs next and switches to the next lookup, so the
+    // cache misses of the whole group overlap instead of forming one dependent chain per word
+    void contains_words(std::span<const std::string_view> queries, std::vector<bool> &result)
+    {
+        static constexpr int GROUP_SIZE = 16;
+        struct Lookup
+        {
+            int query;
+            uint32_t pos;
+            uint32_t v;
+            bool is_word;
+            // offsets of v have been read and its edges prefetched
+            bool edges_ready;
+            int edges_begin;
+            int edges_end;
+        };
+
+        result.assign(queries.size(), false);
+        int next_query = 0;
+        auto start_lookup = [&](Lookup &l)
+        {
+            if (next_query == (int)queries.size())
+                return false;
+            l = {next_query++, 0, 0, false, false, 0, 0};
+            return true;
+        };
+
+        Lookup group[GROUP_SIZE];
+        int active = 0;
+        while (active < GROUP_SIZE && start_lookup(group[active]))
+        {
+            active++;
+        }
+
+        while (active > 0)
+        {
+            for (int i = 0; i < active;)
+            {
+                Lookup &l = group[i];
+                std::string_view s = queries[l.query];
+                bool done = false;
+                if (l.pos == s.size())
+                {
+                    result[l.query] = l.is_word;
+                    done = true;
+                }
+                else if (!l.edges_ready)
+                {
+                    l.edges_begin = graph.nodes[l.v];
+                    l.edges_end = graph.nodes[l.v + 1];
+                    __builtin_prefetch(&graph.edges[l.edges_begin]);
+                    l.edges_ready = true;
+                }
+                else
+                {
+                    char c = s[l.pos];
+                    bool found = false;
+                    for (int j = l.edges_begin; j < l.edges_end; j++)
+                    {
+                        auto &e = graph.edges[j];
+                        if (e.get_letter() == c)
+                        {
+                            found = true;
+                            l.is_word = e.is_word();
+                            l.v = e.get_id();
+                            break;
+                        }
+                    }
+                    if (found)
+                    {
+                        l.pos++;
+                        l.edges_ready = false;
+                        __builtin_prefetch(&graph.nodes[l.v]);
+                    }
+                    else
+                    {
+                        done = true;
+                    }
+                }
+
+                if (done && !start_lookup(l))
+                {
+                    group[i] = group[--active];
+                    continue;
+                }
+                i++;
+            }
+        }
+    }
+
     AdjacencyArray<EdgeType> graph;
 };
\ No newline at end of file
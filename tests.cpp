@@ -7,6 +7,19 @@
 #include "static_trie.h"
 #include "io.h"
 #include "small_map.h"
+#include "bloom_filter.h"
+#include "perfect_hash.h"
+#include "prefix_completer.h"
+#include "fuzzy_search.h"
+#include "fm_index.h"
+#include "pattern_search.h"
+#include "feedback.h"
+#include "wordle.h"
+#include "word_challenge.h"
+#include "application.h"
+#include <filesystem>
+#include <map>
+#include <set>
 
 TEST(TrieTest, SmallDictionary)
 {
@@ -16,15 +29,94 @@ TEST(TrieTest, SmallDictionary)
     TrieArray trie2(words);
     StaticTrieGraph<TrieEdge> trie3(words);
     StaticTrieGraph<CompressedTrieEdge> trie4(words);
+    TrieArena trie5(words);
+    TrieArrayArena trie6(words);
+    PerfectHashWordSet set1(words, 1);
+    PerfectHashWordSet set2(words, 3);
     for (auto &s : words)
     {
+        ASSERT_TRUE(set1.contains_word(s));
+        ASSERT_TRUE(set2.contains_word(s));
         ASSERT_TRUE(trie1.contains_word(s));
         ASSERT_TRUE(trie2.contains_word(s));
         ASSERT_TRUE(trie3.contains_word(s));
         ASSERT_TRUE(trie4.contains_word(s));
+        ASSERT_TRUE(trie5.contains_word(s));
+        ASSERT_TRUE(trie6.contains_word(s));
     }
 }
 
+TEST(TrieTest, PerfectHashDuplicates)
+{
+    std::string file = "../dictionary_9030.txt";
+    auto words = io::read_dictionary(file);
+    // every word twice, more than one block per thread, so duplicates land in different blocks
+    WordList doubled = words;
+    doubled.insert(doubled.end(), words.begin(), words.end());
+    std::set<std::string> distinct(words.begin(), words.end());
+    PerfectHashWordSet set(doubled, 3);
+    ASSERT_EQ(set.word_ids.size(), distinct.size());
+    // each slot holds a different word
+    std::set<std::string> slot_words;
+    for (uint32_t id : set.word_ids)
+    {
+        slot_words.insert(doubled[id]);
+    }
+    ASSERT_EQ(slot_words, distinct);
+    for (auto &s : doubled)
+    {
+        ASSERT_TRUE(set.contains_word(s));
+    }
+}
+
+TEST(TrieTest, ArenaTrieSameGraph)
+{
+    std::string file = "../dictionary_9030.txt";
+    auto words = io::read_dictionary(file);
+    Trie trie1(words);
+    TrieArena trie2(words);
+    TrieArrayArena trie3(words);
+    ASSERT_EQ(trie1.get_num_nodes(), trie2.get_num_nodes());
+    ASSERT_EQ(trie1.get_num_nodes(), trie3.get_num_nodes());
+
+    auto list1 = trie1.extract_graph<TrieEdge>();
+    auto list2 = trie2.extract_graph<TrieEdge>();
+    auto list3 = trie3.extract_graph<TrieEdge>();
+    auto graph1 = AdjacencyArray(list1);
+    auto graph2 = AdjacencyArray(list2);
+    auto graph3 = AdjacencyArray(list3);
+    ASSERT_TRUE(graph1.nodes == graph2.nodes);
+    ASSERT_TRUE(graph1.nodes == graph3.nodes);
+    for (int i = 0; i < graph1.num_edges(); i++)
+    {
+        ASSERT_EQ(graph1.edges[i].get_id(), graph2.edges[i].get_id());
+        ASSERT_EQ(graph1.edges[i].get_letter(), graph2.edges[i].get_letter());
+        ASSERT_EQ(graph1.edges[i].is_word(), graph2.edges[i].is_word());
+        ASSERT_EQ(graph1.edges[i].get_id(), graph3.edges[i].get_id());
+        ASSERT_EQ(graph1.edges[i].get_letter(), graph3.edges[i].get_letter());
+        ASSERT_EQ(graph1.edges[i].is_word(), graph3.edges[i].is_word());
+    }
+}
+
+TEST(TrieTest, ArenaTrieAllByteChildren)
+{
+    // a node with a child for every byte value, e.g. from non ascii input
+    std::vector<std::string> words;
+    for (int b = 0; b < 256; b++)
+    {
+        words.push_back(std::string("x") + (char)b);
+    }
+    TrieArena trie(words);
+    ASSERT_EQ(trie.get_num_nodes(), 258);
+    ASSERT_EQ(trie.node(1).num_children(), 256);
+    for (auto &w : words)
+    {
+        ASSERT_TRUE(trie.contains_word(w));
+    }
+    std::string prefix = "x";
+    ASSERT_FALSE(trie.contains_word(prefix));
+}
+
 TEST(TrieTest, PositveAndNegative)
 {
     std::vector<std::string> v1 = {"apple", "banana", "pear", "grape"};
@@ -33,8 +125,10 @@ TEST(TrieTest, PositveAndNegative)
     TrieArray trie2(v1);
     StaticTrieGraph<TrieEdge> trie3(v1);
     StaticTrieGraph<CompressedTrieEdge> trie4(v1);
+    PerfectHashWordSet set(v1);
     for (auto &s : v1)
     {
+        ASSERT_TRUE(set.contains_word(s));
         ASSERT_TRUE(trie1.contains_word(s));
         ASSERT_TRUE(trie2.contains_word(s));
         ASSERT_TRUE(trie3.contains_word(s));
@@ -42,6 +136,7 @@ TEST(TrieTest, PositveAndNegative)
     }
     for (auto &s : v2)
     {
+        ASSERT_FALSE(set.contains_word(s));
         ASSERT_FALSE(trie1.contains_word(s));
         ASSERT_FALSE(trie2.contains_word(s));
         ASSERT_FALSE(trie3.contains_word(s));
@@ -49,6 +144,855 @@ TEST(TrieTest, PositveAndNegative)
     }
 }
 
+TEST(TrieTest, BatchedLookup)
+{
+    std::vector<std::string> v = {"apple", "banana", "pear", "grape", "appl", "bpple", "banaa", "par", "grpe", "", "applepie"};
+    std::vector<std::string> words = {"apple", "banana", "pear", "grape"};
+    TrieArray trie1(words);
+    StaticTrieGraph<TrieEdge> trie2(words);
+    std::vector<std::string_view> queries(v.begin(), v.end());
+    std::vector<bool> result1, result2;
+    trie1.contains_words(queries, result1);
+    trie2.contains_words(queries, result2);
+    ASSERT_EQ(result1.size(), v.size());
+    ASSERT_EQ(result2.size(), v.size());
+    for (uint i = 0; i < v.size(); i++)
+    {
+        ASSERT_EQ(result1[i], trie1.contains_word(v[i]));
+        ASSERT_EQ(result2[i], trie2.contains_word(v[i]));
+    }
+}
+
+TEST(TrieTest, PrefixCompletion)
+{
+    std::string file = "../dictionary_9030.txt";
+    auto words = io::read_dictionary(file);
+    std::mt19937 gen(0);
+    std::vector<float> weights(words.size());
+    for (auto &w : weights)
+    {
+        // few distinct weights, so that ties have to be broken lexicographically
+        w = gen() % 5;
+    }
+    std::vector<float> weights_copy = weights;
+    PrefixCompleter completer(words, std::move(weights_copy));
+
+    std::vector<std::string> prefixes = {"", "a", "st", "pre", "zz", "tion", "abcdef"};
+    for (auto &prefix : prefixes)
+    {
+        for (uint word_length : {0, 5, 8})
+        {
+            std::vector<int> expected;
+            for (uint i = 0; i < words.size(); i++)
+            {
+                if (words[i].starts_with(prefix) && (word_length == 0 || words[i].size() == word_length))
+                {
+                    expected.push_back(i);
+                }
+            }
+            std::sort(expected.begin(), expected.end(), [&](int a, int b)
+                      { return weights[a] != weights[b] ? weights[a] > weights[b] : words[a] < words[b]; });
+            expected.resize(std::min<size_t>(expected.size(), 10));
+            ASSERT_EQ(completer.complete(prefix, 10, word_length), expected);
+        }
+    }
+}
+
+TEST(TrieTest, FuzzySearch)
+{
+    std::string file = "../dictionary_9030.txt";
+    auto words = io::read_dictionary(file);
+    FuzzySearch fuzzy(words);
+    std::vector<std::string> queries = {"apple", "aple", "applle", "hous", "xqzv", "a", "strenght", "zzzzzzzzzz"};
+    for (auto &q : queries)
+    {
+        for (int k = 0; k <= 2; k++)
+        {
+            std::vector<std::pair<int, std::string>> expected;
+            for (auto &w : words)
+            {
+                int d = edit_distance(q, w);
+                if (d <= k)
+                {
+                    expected.push_back({d, w});
+                }
+            }
+            std::sort(expected.begin(), expected.end());
+            std::vector<std::pair<int, std::string>> result;
+            for (auto &match : fuzzy.search(q, k))
+            {
+                result.push_back({match.distance, words[match.word_index]});
+            }
+            ASSERT_EQ(result, expected);
+        }
+    }
+}
+
+TEST(FMIndexTest, SameAsScan)
+{
+    std::string file = "../dictionary_9030.txt";
+    auto words = io::read_dictionary(file);
+    FMIndex index(words);
+    std::string text = "#";
+    for (auto &w : words)
+    {
+        text += w + "#";
+    }
+
+    std::vector<std::string> patterns = {"ell", "ing#", "#re", "#apple#", "a", "q", "zzz", "tion", "#", "x#"};
+    for (auto &p : patterns)
+    {
+        std::vector<int> positions;
+        for (size_t pos = text.find(p); pos != std::string::npos; pos = text.find(p, pos + 1))
+        {
+            positions.push_back(pos);
+        }
+        ASSERT_EQ(index.count(p), (int)positions.size());
+        ASSERT_EQ(index.locate(p), positions);
+    }
+
+    std::vector<std::string> infixes = {"ell", "ing", "a", "qu", "zzz"};
+    for (auto &s : infixes)
+    {
+        std::vector<int> containing, ending, starting;
+        for (uint i = 0; i < words.size(); i++)
+        {
+            if (words[i].find(s) != std::string::npos)
+                containing.push_back(i);
+            if (words[i].ends_with(s))
+                ending.push_back(i);
+            if (words[i].starts_with(s))
+                starting.push_back(i);
+        }
+        ASSERT_EQ(index.words_containing(s), containing);
+        ASSERT_EQ(index.words_ending_with(s), ending);
+        ASSERT_EQ(index.words_starting_with(s), starting);
+    }
+}
+
+TEST(TrieTest, PatternSearch)
+{
+    std::string file = "../dictionary_9030.txt";
+    auto words = io::read_dictionary(file);
+    PatternSearch pattern_search(words);
+    std::vector<std::string> patterns = {"c?t*", "[aeiou]..e.", "..... -s +r", "*", "*ing", "s*s", "[^a-r]*e", "a*b*c*", "* +eee", "*ee* -a", "....", "zzzzz", "[xyz]"};
+    for (auto &pattern : patterns)
+    {
+        PatternQuery query;
+        ASSERT_TRUE(query.parse(pattern));
+        std::vector<std::string> expected;
+        for (auto &w : words)
+        {
+            if (query.matches(w))
+            {
+                expected.push_back(w);
+            }
+        }
+        // the dictionary has duplicates
+        std::sort(expected.begin(), expected.end());
+        expected.erase(std::unique(expected.begin(), expected.end()), expected.end());
+        std::vector<std::string> result;
+        for (int i : pattern_search.search(query))
+        {
+            result.push_back(words[i]);
+        }
+        ASSERT_EQ(result, expected);
+    }
+
+    PatternQuery query;
+    ASSERT_TRUE(query.parse("cat"));
+    ASSERT_TRUE(query.matches("cat"));
+    ASSERT_FALSE(query.matches("cats"));
+    for (std::string invalid : {"c[at", "c3t", "[z-a]", "cat s", "cat +"})
+    {
+        ASSERT_FALSE(query.parse(invalid));
+    }
+}
+
+TEST(WordleTest, FeedbackMatrix)
+{
+    std::string file = "../dictionary_9030.txt";
+    auto words = io::read_dictionary(file);
+    std::string cache_dir = std::filesystem::temp_directory_path();
+    std::filesystem::remove(cache_dir + "/feedback_4.bin");
+
+    FeedbackMatrix full(words);
+    FeedbackMatrix lazy(words, "", 0);
+    FeedbackMatrix cached(words, cache_dir);
+    cached.table(4);
+    FeedbackMatrix loaded(words, cache_dir);
+    ASSERT_TRUE(loaded.table(4).from_cache);
+    ASSERT_TRUE(lazy.table(5).lazy);
+
+    Wordle wordle(words);
+    std::mt19937 gen(0);
+    for (int len : {3, 4, 5, 7})
+    {
+        auto &index = full.words_of_len[len];
+        WordleHint hint(len);
+        for (int i = 0; i < 2000; i++)
+        {
+            int g = gen() % index.size();
+            int s = gen() % index.size();
+            wordle.set_secret_word(words[index[s]]);
+            wordle.get_wordle_hint(hint, words[index[g]]);
+            uint64_t code = 0;
+            for (int p = len - 1; p >= 0; p--)
+            {
+                code = code * 3 + hint[p];
+            }
+            ASSERT_EQ(pattern_code(words[index[g]], words[index[s]]), code);
+            ASSERT_EQ(full.table(len).code(g, s), code);
+            ASSERT_EQ(lazy.table(len).code(g, s), code);
+            ASSERT_EQ(full.code_of_words(index[g], index[s]), code);
+            if (len == 4)
+            {
+                ASSERT_EQ(loaded.table(len).code(g, s), code);
+            }
+        }
+    }
+    std::filesystem::remove(cache_dir + "/feedback_4.bin");
+}
+
+TEST(WordleTest, BatchPatternCodes)
+{
+    // all words over {a, b, c} of length 5 against each other
+    WordList small;
+    for (int w = 0; w < 243; w++)
+    {
+        std::string word;
+        for (int i = 0, x = w; i < 5; i++, x /= 3)
+        {
+            word += 'a' + x % 3;
+        }
+        small.push_back(word);
+    }
+    std::string file = "../dictionary_9030.txt";
+    auto file_words = io::read_dictionary(file);
+
+    for (auto *words : {&small, &file_words})
+    {
+        Wordle wordle(*words);
+        auto words_of_len = compute_index_word_of_len(*words);
+        for (int len = 1; len < std::min<int>(words_of_len.size(), MAX_BATCH_LENGTH + 1); len++)
+        {
+            auto &index = words_of_len[len];
+            if (index.empty())
+                continue;
+            SecretBatch batch(*words, index);
+            std::vector<uint32_t> codes(batch.stride);
+            WordleHint hint(len);
+            // every guess for the small words, a sample of the dictionary
+            int step = words == &small ? 1 : 1 + index.size() / 50;
+            for (uint g = 0; g < index.size(); g += step)
+            {
+                std::string &guess = (*words)[index[g]];
+                batch_pattern_codes(guess, batch, codes.data());
+                for (uint s = 0; s < index.size(); s++)
+                {
+                    wordle.set_secret_word((*words)[index[s]]);
+                    wordle.get_wordle_hint(hint, guess);
+                    uint64_t code = 0;
+                    for (int p = len - 1; p >= 0; p--)
+                    {
+                        code = code * 3 + hint[p];
+                    }
+                    ASSERT_EQ(codes[s], code) << guess << " " << (*words)[index[s]];
+                    ASSERT_EQ(pattern_code(guess, (*words)[index[s]]), code);
+                }
+            }
+        }
+    }
+}
+
+TEST(WordleTest, DecisionTree)
+{
+    std::string file = "../dictionary_9030.txt";
+    auto words = io::read_dictionary(file);
+    FeedbackMatrix feedback(words);
+    Wordle wordle(words);
+    std::string path = std::string(std::filesystem::temp_directory_path()) + "/decision_tree_test.bin";
+
+    for (int len : {3, 5})
+    {
+        auto &table = feedback.table(len);
+        DecisionTreeSolver solver(table, TreeObjective::WORST_CASE);
+        DecisionTree built = solver.solve();
+        built.save(path, table.dictionary_hash());
+        DecisionTree tree;
+        ASSERT_TRUE(tree.load(path, len, TreeObjective::WORST_CASE, table.dictionary_hash(), words));
+        ASSERT_FALSE(DecisionTree().load(path, len, TreeObjective::EXPECTED, table.dictionary_hash(), words));
+        ASSERT_EQ(tree.nodes.size(), built.nodes.size());
+
+        // truncated and corrupted files are rejected
+        std::filesystem::resize_file(path, std::filesystem::file_size(path) - 1);
+        ASSERT_FALSE(DecisionTree().load(path, len, TreeObjective::WORST_CASE, table.dictionary_hash(), words));
+        DecisionTree corrupted = built;
+        corrupted.children[0].node = corrupted.nodes.size();
+        corrupted.save(path, table.dictionary_hash());
+        ASSERT_FALSE(DecisionTree().load(path, len, TreeObjective::WORST_CASE, table.dictionary_hash(), words));
+        corrupted = built;
+        corrupted.nodes[0].num_children = corrupted.children.size() + 1;
+        corrupted.save(path, table.dictionary_hash());
+        ASSERT_FALSE(DecisionTree().load(path, len, TreeObjective::WORST_CASE, table.dictionary_hash(), words));
+        corrupted = built;
+        corrupted.nodes[0].guess = std::find_if(words.begin(), words.end(), [&](std::string &w)
+                                                { return (int)w.size() != len; }) -
+                                   words.begin();
+        corrupted.save(path, table.dictionary_hash());
+        ASSERT_FALSE(DecisionTree().load(path, len, TreeObjective::WORST_CASE, table.dictionary_hash(), words));
+
+        // every secret is found within the depth of the tree by replaying the hints
+        int max_depth = 0;
+        long long total_depth = 0;
+        std::unordered_set<std::string> secrets;
+        WordleHint hint(len);
+        for (int s : table.word_indices)
+        {
+            if (!secrets.insert(words[s]).second)
+                continue;
+            wordle.set_secret_word(words[s]);
+            int v = 0;
+            int depth = 1;
+            while (words[tree.nodes[v].guess] != words[s])
+            {
+                wordle.get_wordle_hint(hint, words[tree.nodes[v].guess]);
+                uint64_t code = 0;
+                for (int p = len - 1; p >= 0; p--)
+                {
+                    code = code * 3 + hint[p];
+                }
+                v = tree.child(v, code);
+                ASSERT_NE(v, -1);
+                depth++;
+            }
+            max_depth = std::max(max_depth, depth);
+            total_depth += depth;
+        }
+        ASSERT_EQ(max_depth, tree.max_depth);
+        ASSERT_EQ(total_depth, tree.total_depth);
+        ASSERT_EQ((int)secrets.size(), tree.num_secrets);
+    }
+    std::filesystem::remove(path);
+
+    // the guesser replays the tree
+    WordleSimulation sim(words, 20, 1, GuesserStrategy::DECISION_TREE);
+    for (auto &w : {std::string("house"), std::string("count"), std::string("abc")})
+    {
+        if (std::find(words.begin(), words.end(), w) == words.end())
+            continue;
+        ASSERT_TRUE(sim.play_one_round(w));
+    }
+}
+
+TEST(WordleTest, OpeningBook)
+{
+    std::string file = "../dictionary_9030.txt";
+    auto words = io::read_dictionary(file);
+    std::string path = std::string(std::filesystem::temp_directory_path()) + "/opening_book_test.bin";
+    auto book = std::make_shared<OpeningBook>(OpeningBookBuilder(words).build());
+    book->save(path);
+    OpeningBook loaded;
+    ASSERT_TRUE(loaded.load(path, words));
+    ASSERT_EQ(loaded.first_guess, book->first_guess);
+
+    // truncated files and guesses outside the dictionary are rejected
+    std::filesystem::resize_file(path, std::filesystem::file_size(path) - 1);
+    ASSERT_FALSE(OpeningBook().load(path, words));
+    OpeningBook corrupted = *book;
+    corrupted.second_guess[4][0].guess = words.size();
+    corrupted.save(path);
+    ASSERT_FALSE(OpeningBook().load(path, words));
+    corrupted = *book;
+    corrupted.second_guess[4][0].guess = book->first_guess[5];
+    corrupted.save(path);
+    ASSERT_FALSE(OpeningBook().load(path, words));
+    std::filesystem::remove(path);
+
+    // first guess by scalar pattern codes
+    auto words_of_len = compute_index_word_of_len(words);
+    auto &index = words_of_len[4];
+    double best_cost = 1e18;
+    int best = -1;
+    for (int g : index)
+    {
+        std::map<uint64_t, int> classes;
+        for (int s : index)
+        {
+            classes[pattern_code(words[g], words[s])]++;
+        }
+        double cost = 0;
+        for (auto [code, c] : classes)
+        {
+            cost += c * std::log2(c);
+        }
+        if (cost < best_cost - 1e-9)
+        {
+            best_cost = cost;
+            best = g;
+        }
+    }
+    ASSERT_EQ(words[book->first_guess[4]], words[best]);
+
+    for (int len = 1; len < (int)book->first_guess.size(); len++)
+    {
+        if (!book->has_length(len))
+            continue;
+        uint total = 0;
+        for (auto &entry : loaded.second_guess[len])
+        {
+            total += entry.num_secrets;
+        }
+        ASSERT_EQ(total, words_of_len[len].size());
+    }
+
+    // the entropy guesser plays the book, the letter frequency guesser ignores it
+    Wordle wordle(words);
+    RandomWordleGuesser letter_frequency(words, 1, GuesserStrategy::LETTER_FREQUENCY);
+    RandomWordleGuesser letter_frequency_book(words, 1, GuesserStrategy::LETTER_FREQUENCY);
+    letter_frequency_book.opening_book = book;
+    letter_frequency.new_word(4);
+    letter_frequency_book.new_word(4);
+    ASSERT_EQ(letter_frequency_book.make_guess(), letter_frequency.make_guess());
+    RandomWordleGuesser guesser(words, 1, GuesserStrategy::ENTROPY);
+    guesser.opening_book = book;
+    for (int s : index)
+    {
+        wordle.set_secret_word(words[s]);
+        guesser.new_word(4);
+        std::string guess = guesser.make_guess();
+        ASSERT_EQ(guess, words[book->first_guess[4]]);
+        if (guess == words[s])
+            continue;
+        WordleHint hint(4);
+        wordle.get_wordle_hint(hint, guess);
+        guesser.take_hint(hint, guess);
+        ASSERT_EQ(guesser.make_guess(), words[book->find_second(4, pattern_code(guess, words[s]))->guess]);
+    }
+}
+
+TEST(WordleTest, BitsetCandidatesSameAsTrie)
+{
+    std::string file = "../dictionary_9030.txt";
+    auto words = io::read_dictionary(file);
+    Wordle wordle(words);
+    RandomWordGenerator word_gen(words, 3);
+
+    for (auto strategy : {GuesserStrategy::RANDOM_CANDITATE, GuesserStrategy::LETTER_FREQUENCY})
+    {
+        RandomWordleGuesser trie_guesser(words, 7, strategy);
+        RandomWordleGuesser bitset_guesser(words, 7, strategy);
+        bitset_guesser.use_candidate_engine(CandidateEngine::BITSET);
+        for (int len = 3; len <= 12; len++)
+        {
+            if (word_gen.count_words_of_len(len) == 0)
+                continue;
+            for (auto &secret : word_gen.n_random_words_of_len(20, len))
+            {
+                wordle.set_secret_word(secret);
+                trie_guesser.new_word(len);
+                bitset_guesser.new_word(len);
+                WordleHint hint(len);
+                for (int i = 0; i < 10; i++)
+                {
+                    std::string guess = trie_guesser.make_guess();
+                    ASSERT_EQ(bitset_guesser.make_guess(), guess);
+                    ASSERT_EQ(bitset_guesser.canditate_index, trie_guesser.canditate_index);
+                    if (trie_guesser.has_narrowed_index)
+                    {
+                        // narrowed list is the same as a new search
+                        auto narrowed = trie_guesser.narrowed_index;
+                        trie_guesser.search_candidates_trie();
+                        ASSERT_EQ(trie_guesser.canditate_index, narrowed);
+                    }
+                    if (guess == secret)
+                        break;
+                    wordle.get_wordle_hint(hint, guess);
+                    trie_guesser.take_hint(hint, guess);
+                    bitset_guesser.take_hint(hint, guess);
+                }
+            }
+        }
+    }
+}
+
+TEST(WordleTest, SharedIndex)
+{
+    std::string file = "../dictionary_9030.txt";
+    auto words = io::read_dictionary(file);
+    auto index = std::make_shared<WordleIndex>(words);
+    RandomWordGenerator word_gen(words, 5);
+    std::vector<std::vector<std::string>> secrets;
+    for (int len = 4; len <= 7; len++)
+    {
+        secrets.push_back(word_gen.n_random_words_of_len(10, len));
+    }
+
+    // guessers on the shared index prepare the lengths concurrently
+    auto play = [&](RandomWordleGuesser &guesser)
+    {
+        Wordle wordle(words);
+        std::vector<std::string> guesses;
+        for (auto &secrets_of_len : secrets)
+        {
+            int len = secrets_of_len[0].size();
+            for (auto &secret : secrets_of_len)
+            {
+                wordle.set_secret_word(secret);
+                guesser.new_word(len);
+                WordleHint hint(len);
+                for (int i = 0; i < 10; i++)
+                {
+                    std::string guess = guesser.make_guess();
+                    guesses.push_back(guess);
+                    if (guess == secret)
+                        break;
+                    wordle.get_wordle_hint(hint, guess);
+                    guesser.take_hint(hint, guess);
+                }
+            }
+        }
+        return guesses;
+    };
+    RandomWordleGuesser shared_a(index, 11, GuesserStrategy::LETTER_FREQUENCY);
+    RandomWordleGuesser shared_b(index, 11, GuesserStrategy::LETTER_FREQUENCY);
+    shared_b.use_candidate_engine(CandidateEngine::BITSET);
+    std::vector<std::string> guesses_a, guesses_b;
+    parallel_for_each(2, 2, [&](int t)
+                      {
+        if (t == 0)
+            guesses_a = play(shared_a);
+        else
+            guesses_b = play(shared_b); });
+
+    RandomWordleGuesser own(words, 11, GuesserStrategy::LETTER_FREQUENCY);
+    auto guesses = play(own);
+    ASSERT_EQ(guesses_a, guesses);
+    ASSERT_EQ(guesses_b, guesses);
+    ASSERT_EQ(&shared_a.graph, &shared_b.graph);
+}
+
+TEST(WordleTest, ParallelSimulationDeterministic)
+{
+    std::string file = "../dictionary_9030.txt";
+    auto words = io::read_dictionary(file);
+    auto index = std::make_shared<WordleIndex>(words);
+    RandomWordGenerator word_gen(words, 9);
+    auto secrets = word_gen.n_random_words_of_len(60, 5);
+    auto extra = word_gen.n_random_words_of_len(20, 6);
+    secrets.insert(secrets.end(), extra.begin(), extra.end());
+
+    for (auto strategy : {GuesserStrategy::RANDOM_CANDITATE, GuesserStrategy::LETTER_FREQUENCY, GuesserStrategy::ENTROPY, GuesserStrategy::DECISION_TREE})
+    {
+        ParallelWordleSimulation single(index, 20, 4, strategy, 1);
+        ParallelWordleSimulation multi(index, 20, 4, strategy, 3);
+        ASSERT_EQ(single.play(secrets), multi.play(secrets));
+        auto [guesses_1, visited_1, canditates_1, time_1] = single.get_log_data();
+        auto [guesses_3, visited_3, canditates_3, time_3] = multi.get_log_data();
+        ASSERT_EQ(guesses_1.size(), secrets.size());
+        ASSERT_EQ(guesses_1, guesses_3);
+        ASSERT_EQ(visited_1, visited_3);
+        ASSERT_EQ(canditates_1, canditates_3);
+        ASSERT_EQ(single.found_secret, multi.found_secret);
+    }
+}
+
+TEST(WordleTest, GuessedWordsPerGame)
+{
+    std::string file = "../dictionary_9030.txt";
+    auto words = io::read_dictionary(file);
+    RandomWordleGuesser guesser(words, 1, GuesserStrategy::LETTER_FREQUENCY);
+    auto index_of = [&](std::string &w)
+    { return (int)(std::find(words.begin(), words.end(), w) - words.begin()); };
+
+    // a guess of game N is not guessed in game N + 1, the same start word is guessed again
+    guesser.new_word(5);
+    std::string first = guesser.make_guess();
+    ASSERT_TRUE(guesser.was_guessed(index_of(first)));
+    guesser.new_word(5);
+    ASSERT_FALSE(guesser.was_guessed(index_of(first)));
+    ASSERT_EQ(guesser.make_guess(), first);
+
+    // on wrap around of the epoch all stamps are cleared, also stale stamps equal to the new epoch
+    int stale = index_of(words[1]);
+    guesser.guessed_epoch[stale] = 1;
+    guesser.guess_epoch = UINT32_MAX - 1;
+    guesser.new_word(5);
+    std::string last = guesser.make_guess();
+    ASSERT_TRUE(guesser.was_guessed(index_of(last)));
+    guesser.new_word(5);
+    ASSERT_EQ(guesser.guess_epoch, 1u);
+    ASSERT_FALSE(guesser.was_guessed(index_of(last)));
+    ASSERT_FALSE(guesser.was_guessed(stale));
+    ASSERT_EQ(guesser.make_guess(), first);
+    ASSERT_TRUE(guesser.was_guessed(index_of(first)));
+}
+
+TEST(WordleTest, AllSecretsEvaluation)
+{
+    std::string file = "../dictionary_9030.txt";
+    auto all_words = io::read_dictionary(file);
+    WordList words(all_words.begin(), all_words.begin() + 300);
+    // duplicates are played once
+    words.push_back(words[0]);
+    words.push_back(words[1]);
+    WordleApplication app(words, 7, GuesserStrategy::RANDOM_CANDITATE);
+    app.simulation_threads = 3;
+    int max_guesses = 20;
+    auto evaluations = app.evaluate_all_secrets(max_guesses);
+
+    auto words_of_len = compute_index_word_of_len(words);
+    WordleSimulation sim(app.index, max_guesses, 0, GuesserStrategy::RANDOM_CANDITATE);
+    size_t total_games = 0;
+    for (auto &[len, secrets, guesses, found, time] : evaluations)
+    {
+        std::set<std::string> expected;
+        for (int idx : words_of_len[len])
+        {
+            expected.insert(words[idx]);
+        }
+        ASSERT_EQ(std::set<std::string>(secrets.begin(), secrets.end()), expected);
+        ASSERT_EQ(secrets.size(), expected.size());
+        ASSERT_EQ(guesses.size(), secrets.size());
+        total_games += secrets.size();
+
+        // a sequential loop with the same game seeds
+        long long sum_guesses = 0, expected_sum = 0;
+        int num_found = 0, expected_found = 0;
+        for (uint i = 0; i < secrets.size(); i++)
+        {
+            sim.guesser.gen = RandomGenerator(ParallelWordleSimulation::game_seed(app.seed + 1, i));
+            expected_found += sim.play_one_round<false>(secrets[i]);
+            sum_guesses += guesses[i];
+            num_found += found[i];
+        }
+        auto [sequential_guesses, visited, candidates, guess_time] = sim.get_log_data();
+        sim.reset_logging();
+        expected_sum = std::accumulate(sequential_guesses.begin(), sequential_guesses.end(), 0LL);
+        ASSERT_EQ(sum_guesses, expected_sum);
+        ASSERT_EQ(num_found, expected_found);
+    }
+    std::set<std::string> distinct(words.begin(), words.end());
+    ASSERT_EQ(total_games, distinct.size());
+}
+
+// trie search that recounts the letters of the path at every node
+struct ReferenceCandidateSearch
+{
+    RandomWordleGuesser &g;
+    std::vector<int> result;
+    std::string path;
+    int visited = 0;
+
+    void rec(int v, int depth, bool is_word)
+    {
+        visited++;
+        int missing = 0;
+        for (int l = 0; l < ALPHABET_SIZE; l++)
+        {
+            int cnt = std::count(path.begin(), path.end(), l + 'a');
+            if (cnt > g.upper_bound[l])
+                return;
+            missing += std::max(0, g.lower_bound[l] - cnt);
+        }
+        if (g.word_len - depth < missing)
+            return;
+        if (depth == g.word_len)
+        {
+            if (is_word)
+                result.push_back(g.node_to_word_index[v]);
+            return;
+        }
+        for (auto &e : g.graph.neighbors(v))
+        {
+            char c = e.get_letter();
+            char known = g.know_chars[depth];
+            int cnt = std::count(path.begin(), path.end(), c);
+            bool letter_excluded = known == g.UNKNOWN && !(g.allowed_letters[depth] >> (c - 'a') & 1);
+            if (c == known || (known == g.UNKNOWN && !letter_excluded && cnt + 1 <= g.upper_bound[c - 'a']))
+            {
+                path.push_back(c);
+                rec(e.get_id(), depth + 1, e.is_word());
+                path.pop_back();
+            }
+        }
+    }
+};
+
+TEST(WordleTest, IncrementalMissingLetters)
+{
+    std::string file = "../dictionary_9030.txt";
+    auto words = io::read_dictionary(file);
+    Wordle wordle(words);
+    RandomWordGenerator word_gen(words, 13);
+    RandomWordleGuesser guesser(words, 5, GuesserStrategy::RANDOM_CANDITATE);
+    for (int len = 3; len <= 12; len++)
+    {
+        for (auto &secret : word_gen.n_random_words_of_len(10, len))
+        {
+            wordle.set_secret_word(secret);
+            guesser.new_word(len);
+            WordleHint hint(len);
+            for (int i = 0; i < 10; i++)
+            {
+                std::string guess = guesser.make_guess();
+                if (guess == secret)
+                    break;
+                wordle.get_wordle_hint(hint, guess);
+                guesser.take_hint(hint, guess);
+
+                ReferenceCandidateSearch reference{guesser};
+                reference.rec(0, 0, false);
+                guesser.search_candidates_trie();
+                ASSERT_EQ(guesser.canditate_index, reference.result);
+                ASSERT_EQ(guesser.get_visited_nodes(), reference.visited);
+            }
+        }
+    }
+}
+
+TEST(WordleTest, IncrementalNarrowingSameAsFullSearch)
+{
+    std::string file = "../dictionary_9030.txt";
+    auto words = io::read_dictionary(file);
+    Wordle wordle(words);
+    RandomWordGenerator word_gen(words, 17);
+    auto index = std::make_shared<WordleIndex>(words);
+    for (auto engine : {CandidateEngine::TRIE_SEARCH, CandidateEngine::BITSET})
+    {
+        RandomWordleGuesser guesser(index, 3, GuesserStrategy::LETTER_FREQUENCY);
+        guesser.use_candidate_engine(engine);
+        int narrowed_guesses = 0;
+        for (int len : {4, 5, 8})
+        {
+            for (auto &secret : word_gen.n_random_words_of_len(30, len))
+            {
+                wordle.set_secret_word(secret);
+                guesser.new_word(len);
+                WordleHint hint(len);
+                for (int i = 0; i < 10; i++)
+                {
+                    // the same guesser without the candidates of the last guess searches all words
+                    RandomWordleGuesser full = guesser;
+                    full.has_narrowed_index = false;
+                    narrowed_guesses += guesser.has_narrowed_index && (long long)guesser.narrowed_index.size() * (len + ALPHABET_SIZE) < guesser.last_search_cost;
+                    std::string guess = guesser.make_guess();
+                    ASSERT_EQ(full.make_guess(), guess);
+                    auto candidates = guesser.canditate_index;
+                    auto expected = full.canditate_index;
+                    std::sort(candidates.begin(), candidates.end());
+                    std::sort(expected.begin(), expected.end());
+                    ASSERT_EQ(candidates, expected);
+                    if (guess == secret)
+                        break;
+                    wordle.get_wordle_hint(hint, guess);
+                    guesser.take_hint(hint, guess);
+                }
+            }
+        }
+        ASSERT_GT(narrowed_guesses, 0);
+    }
+}
+
+// scalar scoring over letter counts and a max over (score, index) pairs
+int reference_highest_score_word(RandomWordleGuesser &g, std::vector<int> &candidates)
+{
+    int word_length = g.words[candidates[0]].size();
+    CharCounter cnt_freq;
+    for (char c : ALPHABET)
+    {
+        if (g.lower_bound[c - 'a'] > 0 || g.upper_bound[c - 'a'] == 0)
+            continue;
+        for (int idx : candidates)
+        {
+            if (g.index->letter_count(idx).get_count(c) > 0)
+                cnt_freq.increment(c);
+        }
+    }
+    long long sum = std::accumulate(cnt_freq.counter.begin(), cnt_freq.counter.end(), 0);
+    double freq[26];
+    for (int i = 0; i < 26; i++)
+    {
+        freq[i] = (double)cnt_freq.get_count(i + 'a') / sum;
+    }
+    std::vector<std::pair<double, int>> score_word;
+    for (int idx : g.words_of_len[word_length])
+    {
+        double score = 0;
+        for (int j = 0; j < 26; j++)
+        {
+            bool b = g.index->letter_count(idx).get_count(j + 'a') > 0;
+            score += b * freq[j];
+        }
+        score_word.push_back({score, idx});
+    }
+    return std::max_element(score_word.begin(), score_word.end())->second;
+}
+
+TEST(WordleTest, LetterScoreSameAsScalar)
+{
+    std::string file = "../dictionary_9030.txt";
+    auto words = io::read_dictionary(file);
+    Wordle wordle(words);
+    RandomWordGenerator word_gen(words, 17);
+    RandomGenerator gen(3);
+    RandomWordleGuesser guesser(words, 5, GuesserStrategy::LETTER_FREQUENCY);
+    for (int len = 2; len <= 14; len++)
+    {
+        if (word_gen.count_words_of_len(len) == 0)
+            continue;
+        for (auto &secret : word_gen.n_random_words_of_len(10, len))
+        {
+            wordle.set_secret_word(secret);
+            guesser.new_word(len);
+            WordleHint hint(len);
+            ASSERT_EQ(guesser.compute_highest_score_word(guesser.words_of_len[len]), reference_highest_score_word(guesser, guesser.words_of_len[len]));
+            for (int i = 0; i < 10; i++)
+            {
+                std::string guess = guesser.make_guess();
+                if (guess == secret)
+                    break;
+                wordle.get_wordle_hint(hint, guess);
+                guesser.take_hint(hint, guess);
+
+                // candidate sets of every size modulo the vector width
+                auto &all = guesser.words_of_len[len];
+                for (int n : {1, 2, 3, 5, 8, 13})
+                {
+                    auto candidates = gen.n_random_elements(n, all);
+                    ASSERT_EQ(guesser.compute_highest_score_word(candidates), reference_highest_score_word(guesser, candidates));
+                }
+            }
+            // no letter left to score
+            auto upper = guesser.upper_bound;
+            guesser.upper_bound.fill(0);
+            ASSERT_EQ(guesser.compute_highest_score_word(guesser.words_of_len[len]), reference_highest_score_word(guesser, guesser.words_of_len[len]));
+            guesser.upper_bound = upper;
+        }
+    }
+}
+
+TEST(BloomFilterTest, NoFalseNegatives)
+{
+    std::string file = "../dictionary_9030.txt";
+    auto words = io::read_dictionary(file);
+    BlockedBloomFilter filter(words, 0.01);
+    for (auto &s : words)
+    {
+        ASSERT_TRUE(filter.may_contain(s));
+    }
+
+    // words with an upper case letter are never in the dictionary
+    int false_positives = 0;
+    for (auto &s : words)
+    {
+        std::string t = s;
+        t[0] = 'A' + (t[0] - 'a');
+        false_positives += filter.may_contain(t);
+    }
+    ASSERT_LT(false_positives, 0.03 * words.size());
+}
+
 TEST(GraphTest, OrderTest)
 {
     /*
@@ -76,6 +1020,117 @@ TEST(GraphTest, OrderTest)
     ASSERT_TRUE(dfs1 == dfs);
 }
 
+TEST(GraphTest, ParallelConstruction)
+{
+    std::string file = "../dictionary_9030.txt";
+    auto words = io::read_dictionary(file);
+    words.push_back("a");
+    words.push_back("z");
+    Trie trie(words);
+    auto adj_list = trie.extract_graph<TrieEdge>();
+    auto graph1 = AdjacencyArray<TrieEdge>::construct_with_dfs_order(adj_list);
+    for (int threads : {1, 3})
+    {
+        auto graph2 = build_dfs_trie_graph_parallel<TrieEdge>(words, threads);
+        ASSERT_TRUE(graph1.nodes == graph2.nodes);
+        ASSERT_EQ(graph1.num_edges(), graph2.num_edges());
+        for (int i = 0; i < graph1.num_edges(); i++)
+        {
+            ASSERT_EQ(graph1.edges[i].get_id(), graph2.edges[i].get_id());
+            ASSERT_EQ(graph1.edges[i].get_letter(), graph2.edges[i].get_letter());
+            ASSERT_EQ(graph1.edges[i].is_word(), graph2.edges[i].is_word());
+        }
+    }
+}
+
+TEST(GraphTest, ProfiledNodeOrder)
+{
+    std::string file = "../dictionary_9030.txt";
+    auto words = io::read_dictionary(file);
+    std::string path = std::string(std::filesystem::temp_directory_path()) + "/node_order_test.bin";
+    RandomWordGenerator word_gen(words, 3);
+    auto queries = word_gen.n_random_words(200);
+    CharCounter counter;
+
+    WordChallenge wc_dfs(words);
+    wc_dfs.start_recording_visits();
+    for (auto &q : queries)
+    {
+        counter.new_counter(q);
+        wc_dfs.possible_words(counter);
+    }
+    wc_dfs.stop_recording_visits();
+    auto order = wc_dfs.compute_profiled_node_order(words);
+    io::write_node_order(path, order);
+    auto loaded = io::read_node_order(path);
+    ASSERT_EQ(loaded, order);
+
+    // the recorded and reloaded order answers like dfs order
+    WordChallenge wc_profiled(words, loaded);
+    for (auto &q : word_gen.n_random_words(200))
+    {
+        counter.new_counter(q);
+        auto expected = wc_dfs.possible_words(counter);
+        auto result = wc_profiled.possible_words(counter);
+        std::sort(expected.begin(), expected.end());
+        std::sort(result.begin(), result.end());
+        ASSERT_EQ(result, expected);
+    }
+
+    // orders that are not a permutation with the root first are rejected
+    ASSERT_TRUE(is_valid_node_order(order, order.size()));
+    auto duplicate = order;
+    duplicate[1] = duplicate[2];
+    ASSERT_FALSE(is_valid_node_order(duplicate, order.size()));
+    auto out_of_range = order;
+    out_of_range[1] = order.size();
+    ASSERT_FALSE(is_valid_node_order(out_of_range, order.size()));
+    std::filesystem::resize_file(path, std::filesystem::file_size(path) - 1);
+    ASSERT_EXIT(io::read_node_order(path), ::testing::ExitedWithCode(1), "node order file");
+    std::filesystem::remove(path);
+}
+
+TEST(GraphTest, MemoryPolicies)
+{
+    std::string file = "../dictionary_9030.txt";
+    auto words = io::read_dictionary(file);
+    std::vector<int> dfs_order;
+    auto expected = build_trie_graph<AdjacencyArray<TrieEdge>>(words, dfs_order);
+    auto expected_index = construct_node_to_word_index(expected, words);
+    for (auto policy : {MemoryPolicy::CACHE_LINE_ALIGNED, MemoryPolicy::HUGE_PAGES})
+    {
+        auto graph = build_trie_graph<AdjacencyArray<TrieEdge>>(words, dfs_order, policy);
+        auto node_to_word_index = construct_node_to_word_index(graph, words, policy);
+        ASSERT_EQ((uintptr_t)graph.edges.data() % CACHE_LINE_SIZE, 0u);
+        ASSERT_TRUE(std::equal(graph.nodes.begin(), graph.nodes.end(), expected.nodes.begin(), expected.nodes.end()));
+        ASSERT_TRUE(std::equal(node_to_word_index.begin(), node_to_word_index.end(), expected_index.begin(), expected_index.end()));
+        ASSERT_EQ(graph.num_edges(), expected.num_edges());
+        for (int i = 0; i < graph.num_edges(); i++)
+        {
+            ASSERT_EQ(graph.edges[i].get_id(), expected.edges[i].get_id());
+            ASSERT_EQ(graph.edges[i].get_letter(), expected.edges[i].get_letter());
+            ASSERT_EQ(graph.edges[i].is_word(), expected.edges[i].is_word());
+        }
+    }
+
+    // arrays of at least a huge page are mapped, concurrently from several threads, smaller ones
+    // fall back to aligned heap memory
+    size_t mapped_before = huge_page_stats.explicit_bytes + huge_page_stats.transparent_bytes;
+    size_t fallback_before = huge_page_stats.fallback_bytes;
+    int arrays = 4;
+    size_t n = HUGE_PAGE_SIZE / sizeof(uint32_t);
+    parallel_for_each(arrays, arrays, [&](int a)
+                      {
+        PolicyVector<uint32_t> large(n, a, PolicyAllocator<uint32_t>(MemoryPolicy::HUGE_PAGES));
+        PolicyVector<uint32_t> small(16, a, PolicyAllocator<uint32_t>(MemoryPolicy::HUGE_PAGES));
+        EXPECT_EQ((uintptr_t)large.data() % HUGE_PAGE_SIZE, 0u);
+        EXPECT_EQ((uintptr_t)small.data() % CACHE_LINE_SIZE, 0u);
+        EXPECT_EQ(std::count(large.begin(), large.end(), (uint32_t)a), (long)n); });
+    size_t mapped_after = huge_page_stats.explicit_bytes + huge_page_stats.transparent_bytes;
+    ASSERT_EQ(mapped_after - mapped_before, arrays * HUGE_PAGE_SIZE);
+    ASSERT_EQ(huge_page_stats.fallback_bytes - fallback_before, arrays * 16 * sizeof(uint32_t));
+}
+
 TEST(SmallMapTest, TestSorted)
 {
     SmallSortedMap<char, int> map;
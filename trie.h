@@ -6,9 +6,16 @@
 #include <queue>
 #include <type_traits>
 #include <cstdint>
+#include <numeric>
+#include <algorithm>
+#include <bit>
+#include <new>
+#include <span>
+#include <string_view>
 
 #include "small_map.h"
 #include "graph.h"
+#include "arena.h"
 
 struct TrieEdge
 {
@@ -187,6 +194,28 @@ struct Trie
         return nodes.size();
     }
 
+    // vectors grow by doubling, so each one allocated once per power of two of its capacity
+    size_t num_allocations() const
+    {
+        size_t allocations = std::bit_width(nodes.capacity());
+        for (auto &node : nodes)
+        {
+            allocations += std::bit_width(node.children.arr.capacity());
+        }
+        return allocations;
+    }
+
+    // excluding malloc overhead
+    size_t memory_bytes() const
+    {
+        size_t bytes = nodes.capacity() * sizeof(TrieNode);
+        for (auto &node : nodes)
+        {
+            bytes += node.children.arr.capacity() * sizeof(std::pair<char, int>);
+        }
+        return bytes;
+    }
+
     std::vector<int> get_node_degrees()
     {
         std::vector<int> v;
@@ -246,6 +275,11 @@ struct TrieNodeFixedArray
         return {i, false};
     }
 
+    inline std::pair<int, bool> insert_child_if_not_present(char c, int idx, Arena &)
+    {
+        return insert_child_if_not_present(c, idx);
+    }
+
     inline std::pair<int, bool> get_child_if_present(char c) const
     {
         int j = c - 'a';
@@ -253,6 +287,29 @@ struct TrieNodeFixedArray
         return {i, i != -1};
     }
 
+    inline int num_children() const
+    {
+        int cnt = 0;
+        for (int j = 0; j < 26; j++)
+        {
+            cnt += children[j] != -1;
+        }
+        return cnt;
+    }
+
+    // calls f(letter, child) in order of letters
+    template <typename Function>
+    void for_each_child(Function f)
+    {
+        for (int j = 0; j < 26; j++)
+        {
+            if (children[j] != -1)
+            {
+                f((char)('a' + j), children[j]);
+            }
+        }
+    }
+
     inline void set_is_word()
     {
         is_a_word = true;
@@ -319,6 +376,75 @@ struct TrieArray
         return nodes[node_idx].is_word();
     }
 
+    // AMAC style batch lookup, see StaticTrieGraph::contains_words
+    void contains_words(std::span<const std::string_view> queries, std::vector<bool> &result) const
+    {
+        static constexpr int GROUP_SIZE = 16;
+        struct Lookup
+        {
+            int query;
+            uint32_t pos;
+            int v;
+        };
+
+        result.assign(queries.size(), false);
+        int next_query = 0;
+        auto start_lookup = [&](Lookup &l)
+        {
+            if (next_query == (int)queries.size())
+                return false;
+            l = {next_query++, 0, root_idx};
+            return true;
+        };
+
+        Lookup group[GROUP_SIZE];
+        int active = 0;
+        while (active < GROUP_SIZE && start_lookup(group[active]))
+        {
+            active++;
+        }
+
+        while (active > 0)
+        {
+            for (int i = 0; i < active;)
+            {
+                Lookup &l = group[i];
+                std::string_view s = queries[l.query];
+                bool done = false;
+                if (l.pos == s.size())
+                {
+                    result[l.query] = nodes[l.v].is_word();
+                    done = true;
+                }
+                else
+                {
+                    auto [next_idx, exists] = nodes[l.v].get_child_if_present(s[l.pos]);
+                    if (exists)
+                    {
+                        l.v = next_idx;
+                        l.pos++;
+                        // nodes span two cache lines, so prefetch the slot that is read next
+                        if (l.pos < s.size())
+                            __builtin_prefetch(&nodes[l.v].children[s[l.pos] - 'a']);
+                        else
+                            __builtin_prefetch(&nodes[l.v].is_a_word);
+                    }
+                    else
+                    {
+                        done = true;
+                    }
+                }
+
+                if (done && !start_lookup(l))
+                {
+                    group[i] = group[--active];
+                    continue;
+                }
+                i++;
+            }
+        }
+    }
+
     // returns index of new node
     int make_new_node()
     {
@@ -326,6 +452,228 @@ struct TrieArray
         return nodes.size() - 1;
     }
 
+    template <typename EdgeType>
+    AdjacencyList<EdgeType> extract_graph()
+    {
+        std::vector<std::vector<EdgeType>> graph(nodes.size());
+        for (uint v = 0; v < nodes.size(); v++)
+        {
+            nodes[v].for_each_child([&](char letter, int w)
+                                    { graph[v].emplace_back(w, letter, nodes[w].is_word()); });
+        }
+        return AdjacencyList{graph};
+    }
+
+    int get_num_nodes() const
+    {
+        return nodes.size();
+    }
+
+    size_t num_allocations() const { return std::bit_width(nodes.capacity()); }
+    size_t memory_bytes() const { return nodes.capacity() * sizeof(TrieNode); }
+
     std::vector<TrieNode> nodes;
     int root_idx;
 };
+
+struct TrieChild
+{
+    char letter;
+    int id;
+};
+
+// children are stored inline for small degrees and spill to arena arrays otherwise,
+// they are appended unsorted during construction and sorted when the graph is extracted
+struct TrieNodeInline
+{
+    static constexpr int INLINE_CHILDREN = 3;
+    static constexpr int MAX_CHILDREN = 256;
+
+    TrieNodeInline() {}
+
+    inline TrieChild *children() { return capacity == INLINE_CHILDREN ? inline_children : spilled_children; }
+    inline const TrieChild *children() const { return capacity == INLINE_CHILDREN ? inline_children : spilled_children; }
+
+    inline std::pair<int, bool> insert_child_if_not_present(char c, int idx, Arena &arena)
+    {
+        auto [i, exists] = get_child_if_present(c);
+        if (exists)
+        {
+            return {i, false};
+        }
+        if (size == capacity)
+        {
+            // old array stays in the arena until the whole trie is released, a node has at most
+            // one child per byte value
+            int new_capacity = std::min(2 * capacity, MAX_CHILDREN);
+            TrieChild *spill = arena.allocate_array<TrieChild>(new_capacity);
+            std::copy(children(), children() + size, spill);
+            spilled_children = spill;
+            capacity = new_capacity;
+        }
+        children()[size++] = {c, idx};
+        return {idx, true};
+    }
+
+    inline std::pair<int, bool> get_child_if_present(char c) const
+    {
+        const TrieChild *arr = children();
+        for (int i = 0; i < size; i++)
+        {
+            if (arr[i].letter == c)
+            {
+                return {arr[i].id, true};
+            }
+        }
+        return {0, false};
+    }
+
+    // calls f(letter, child) in order of letters
+    template <typename Function>
+    void for_each_child(Function f)
+    {
+        TrieChild *arr = children();
+        std::sort(arr, arr + size, [](const TrieChild &a, const TrieChild &b)
+                  { return a.letter < b.letter; });
+        for (int i = 0; i < size; i++)
+        {
+            f(arr[i].letter, arr[i].id);
+        }
+    }
+
+    inline void set_is_word()
+    {
+        is_a_word = true;
+    }
+
+    inline bool is_word() const
+    {
+        return is_a_word;
+    }
+
+    inline int num_children() const
+    {
+        return size;
+    }
+
+    union
+    {
+        TrieChild inline_children[INLINE_CHILDREN];
+        TrieChild *spilled_children;
+    };
+    // 16 bits, a node can have 256 children; the node stays 32 bytes
+    uint16_t size = 0;
+    uint16_t capacity = INLINE_CHILDREN;
+    bool is_a_word = false;
+};
+
+// nodes and spilled children live in an arena, so construction does no per node allocations
+// and everything is freed at once by release(), e.g. right after the graph is extracted
+template <typename TrieNodeType>
+struct ArenaTrie
+{
+    using TrieNode = TrieNodeType;
+    static constexpr int BLOCK_BITS = 12;
+    static constexpr int BLOCK_SIZE = 1 << BLOCK_BITS;
+
+    ArenaTrie()
+    {
+        root_idx = make_new_node();
+    }
+
+    ArenaTrie(std::vector<std::string> &word_list)
+    {
+        root_idx = make_new_node();
+        for (auto &s : word_list)
+        {
+            insert(s);
+        }
+    }
+
+    void insert(std::string &s)
+    {
+        int node_idx = 0;
+        for (char c : s)
+        {
+            int maybe_next_idx = num_nodes;
+            auto [next_idx, inserted] = node(node_idx).insert_child_if_not_present(c, maybe_next_idx, arena);
+            if (inserted)
+            {
+                make_new_node();
+            }
+            node_idx = next_idx;
+        }
+        node(node_idx).set_is_word();
+    }
+
+    bool contains_word(std::string &s) const
+    {
+        int node_idx = 0;
+        for (char c : s)
+        {
+            auto [next_idx, exists] = node(node_idx).get_child_if_present(c);
+            if (exists)
+            {
+                node_idx = next_idx;
+            }
+            else
+            {
+                return false;
+            }
+        }
+        return node(node_idx).is_word();
+    }
+
+    inline TrieNode &node(int v) { return blocks[v >> BLOCK_BITS][v & (BLOCK_SIZE - 1)]; }
+    inline const TrieNode &node(int v) const { return blocks[v >> BLOCK_BITS][v & (BLOCK_SIZE - 1)]; }
+
+    // returns index of new node, blocks are never moved so there is no copying on growth
+    int make_new_node()
+    {
+        if (num_nodes % BLOCK_SIZE == 0)
+        {
+            blocks.push_back(arena.allocate_array<TrieNode>(BLOCK_SIZE));
+        }
+        new (&node(num_nodes)) TrieNode();
+        return num_nodes++;
+    }
+
+    // same graph as Trie::extract_graph
+    template <typename EdgeType>
+    AdjacencyList<EdgeType> extract_graph()
+    {
+        std::vector<std::vector<EdgeType>> graph(num_nodes);
+        for (int v = 0; v < num_nodes; v++)
+        {
+            graph[v].reserve(node(v).num_children());
+            node(v).for_each_child([&](char letter, int w)
+                                   { graph[v].emplace_back(w, letter, node(w).is_word()); });
+        }
+        return AdjacencyList{graph};
+    }
+
+    // nodes are trivially destructible, so the arena can drop them without visiting them
+    void release()
+    {
+        blocks.clear();
+        blocks.shrink_to_fit();
+        arena.release();
+        num_nodes = 0;
+    }
+
+    int get_num_nodes() const
+    {
+        return num_nodes;
+    }
+
+    size_t num_allocations() const { return arena.num_chunk_allocations() + std::bit_width(blocks.capacity()); }
+    size_t memory_bytes() const { return arena.bytes_reserved + blocks.capacity() * sizeof(TrieNode *); }
+
+    Arena arena;
+    std::vector<TrieNode *> blocks;
+    int num_nodes = 0;
+    int root_idx;
+};
+
+using TrieArena = ArenaTrie<TrieNodeInline>;
+using TrieArrayArena = ArenaTrie<TrieNodeFixedArray>;
@@ -6,31 +6,36 @@
 
 #include "graph.h"
 #include "trie.h"
+#include "static_trie.h"
+#include "concepts.h"
 #include "common.h"
 #include "measure_time.h"
 #include "random.h"
 #include "io.h"
 
-struct WordChallenge
+template <TraversableTrieGraph Graph>
+struct BasicWordChallenge
 {
-    using EdgeType = TrieEdge;
-    // using EdgeType = CompressedTrieEdge;
     using WordList = std::vector<std::string>;
 
-    WordChallenge(WordList &words, bool rearrange_graph = true)
+    // without rearrange_graph nodes keep the insertion order of the trie
+    BasicWordChallenge(WordList &words, bool rearrange_graph = true, MemoryPolicy _policy = MemoryPolicy::DEFAULT_ALLOCATION) : policy(_policy)
     {
-        Trie trie(words);
-        AdjacencyList<EdgeType> adj_list = trie.extract_graph<EdgeType>();
-        if (rearrange_graph)
-        {
-            graph = AdjacencyArray<EdgeType>::construct_with_dfs_order(adj_list);
-            // graph = AdjacencyArray<EdgeType>::construct_with_bfs_order(adj_list);
-        }
-        else
-        {
-            graph = AdjacencyArray(adj_list);
-        }
-        node_to_word_index = StaticTrieGraph<EdgeType>(words).construct_node_to_word_index(words);
+        build_graph(words, !rearrange_graph);
+    }
+
+    // node order maps trie node ids to graph ids, e.g. one computed from a recorded profile
+    BasicWordChallenge(WordList &words, std::vector<int> &_node_order, MemoryPolicy _policy = MemoryPolicy::DEFAULT_ALLOCATION) : node_order(_node_order), policy(_policy)
+    {
+        build_graph(words);
+    }
+
+    // an empty node order stays empty and means dfs order, unless insertion_order sets it to the
+    // identity order of the trie
+    void build_graph(WordList &words, bool insertion_order = false)
+    {
+        graph = build_trie_graph<Graph>(words, node_order, policy, insertion_order);
+        node_to_word_index = construct_node_to_word_index(graph, words, policy);
     }
 
     std::vector<int> possible_words(CharCounter &char_count)
@@ -48,6 +53,10 @@ struct WordChallenge
     void rec(std::vector<std::vector<int>> &words_of_length, CharCounter &counter, std::string &word, int v)
     {
         visited_nodes++;
+        if (record_visits)
+        {
+            node_visits[v]++;
+        }
         for (auto &e : graph.neighbors(v))
         {
             char c = e.get_letter();
@@ -80,7 +89,30 @@ struct WordChallenge
     void reset_counter() { visited_nodes = 0; }
     int get_num_visited_nodes() const { return visited_nodes; }
 
-    AdjacencyArray<EdgeType> graph;
-    std::vector<int> node_to_word_index;
+    void start_recording_visits()
+    {
+        record_visits = true;
+        node_visits.assign(graph.num_nodes(), 0);
+    }
+
+    void stop_recording_visits() { record_visits = false; }
+
+    // node order relative to the trie that packs the recorded hot nodes at the front
+    std::vector<int> compute_profiled_node_order(WordList &words, uint32_t min_visits = 1)
+    {
+        auto profile_order = compute_profile_order(graph, node_visits, 0, min_visits);
+        auto order = node_order.empty() ? compute_trie_dfs_order(words) : node_order;
+        return compose_orders(order, profile_order);
+    }
+
+    Graph graph;
+    PolicyVector<int> node_to_word_index;
+    std::vector<int> node_order;
+    MemoryPolicy policy;
     int visited_nodes;
+
+    bool record_visits = false;
+    std::vector<uint32_t> node_visits;
 };
+
+using WordChallenge = BasicWordChallenge<AdjacencyArray<TrieEdge>>;
@@ -4,16 +4,34 @@
 #include <sstream>
 #include <tuple>
 #include <vector>
-#include <unordered_set>
+#include <array>
+#include <algorithm>
+#include <numeric>
+#include <memory>
+#include <functional>
+#include <cmath>
 
 #include "common.h"
 #include "trie.h"
+#include "static_trie.h"
+#include "graph.h"
 #include "random.h"
+#include "bloom_filter.h"
+#include "concepts.h"
+#include "perfect_hash.h"
+#include "feedback.h"
+#include "measure_time.h"
+#include "candidate_bitsets.h"
+#include "decision_tree.h"
+#include "opening_book.h"
+#include "wordle_index.h"
 
 enum GuesserStrategy
 {
     RANDOM_CANDITATE,
     LETTER_FREQUENCY,
+    ENTROPY,
+    DECISION_TREE,
 };
 
 std::string strategy_to_string(GuesserStrategy strategy)
@@ -26,6 +44,14 @@ std::string strategy_to_string(GuesserStrategy strategy)
     {
         return "letter_frequency";
     }
+    else if (strategy == GuesserStrategy::ENTROPY)
+    {
+        return "entropy";
+    }
+    else if (strategy == GuesserStrategy::DECISION_TREE)
+    {
+        return "decision_tree";
+    }
     else
     {
         return "";
@@ -52,9 +78,17 @@ void print_colorful_hint(WordleHint &hint, std::string &word)
     std::cout << "\n";
 }
 
-struct Wordle
+// WordIndex answers the membership queries of is_valid_word, e.g. Trie or PerfectHashWordSet
+template <MembershipIndex WordIndex>
+struct BasicWordle
 {
-    Wordle(WordList &_words) : words(_words), trie(words) {}
+    BasicWordle(WordList &_words) : BasicWordle(_words, std::make_shared<WordIndex>(_words)) {}
+
+    // the index only depends on the dictionary and may be shared, e.g. by the shards of a parallel simulation
+    BasicWordle(WordList &_words, std::shared_ptr<WordIndex> _trie) : words(_words), trie(_trie) {}
+
+    // a bloom filter in front of the index rejects most invalid words with a single cache miss
+    BasicWordle(WordList &_words, double false_positive_rate) : words(_words), trie(std::make_shared<WordIndex>(words)), use_filter(true), filter(words, false_positive_rate) {}
 
     void get_wordle_hint(WordleHint &hints, std::string &guess)
     {
@@ -89,68 +123,55 @@ struct Wordle
 
     void set_secret_word(std::string s) { secret_word = s; }
 
-    bool is_valid_word(std::string &s) { return trie.contains_word(s); }
+    bool is_valid_word(std::string &s)
+    {
+        if (use_filter && !filter.may_contain(s))
+        {
+            return false;
+        }
+        return trie->contains_word(s);
+    }
 
     bool is_secret_word(std::string &s) const { return s == secret_word; }
 
     CharCounter count;
     WordList &words;
-    Trie trie;
+    std::shared_ptr<WordIndex> trie;
+    bool use_filter = false;
+    BlockedBloomFilter filter;
     std::string secret_word;
 };
 
-struct RandomWordleGuesser
+using Wordle = BasicWordle<Trie>;
+
+template <TraversableTrieGraph Graph>
+struct BasicRandomWordleGuesser
 {
-    using EdgeType = TrieEdge;
-    RandomWordleGuesser(WordList &_words, int seed, GuesserStrategy strategy) : words(_words), gen(seed), guesser_strategy(strategy)
+    // node order maps trie node ids to graph ids, if it is empty the graph is dfs ordered
+    BasicRandomWordleGuesser(WordList &_words, int seed, GuesserStrategy strategy, std::vector<int> _node_order = {}, MemoryPolicy policy = MemoryPolicy::DEFAULT_ALLOCATION)
+        : BasicRandomWordleGuesser(std::make_shared<BasicWordleIndex<Graph>>(_words, _node_order, policy), seed, strategy) {}
+
+    // the trie and the letter counts of each length are built on the first new_word of the length
+    BasicRandomWordleGuesser(std::shared_ptr<BasicWordleIndex<Graph>> _index, int seed, GuesserStrategy strategy)
+        : index(_index), words(index->words), gen(seed), guesser_strategy(strategy), graph(index->graph),
+          node_to_word_index(index->node_to_word_index), words_of_len(index->words_of_len), word_position(index->word_position)
     {
-        Trie trie(words);
-        AdjacencyList<EdgeType> adj_list = trie.extract_graph<EdgeType>();
-        graph = AdjacencyArray<EdgeType>::construct_with_dfs_order(adj_list);
-
-        node_to_word_index = StaticTrieGraph<EdgeType>(graph).construct_node_to_word_index(words);
-        words_of_len = compute_index_word_of_len(words);
-
-        // precompute letter count of each word
-        letter_cnt_words = std::vector<CharCounter>(words.size());
-        for (uint i = 0; i < words.size(); i++)
-        {
-            CharCounter cnt(words[i]);
-            letter_cnt_words[i] = cnt;
-        }
-
-        // precompute maximal upper bound for each word length
-        upper_bound_words = std::vector<CharCounter>(words_of_len.size());
-        for (uint i = 0; i < words_of_len.size(); i++)
-        {
-            if (words_of_len[i].size() > 0)
-            {
-                int bound = 0;
-                for (char c : ALPHABET)
-                {
-                    for (auto idx : words_of_len[i])
-                    {
-                        bound = std::max(bound, letter_cnt_words[idx].get_count(c));
-                    }
-                    upper_bound_words[i].set_count(c, bound);
-                }
-                // print_vector(upper_bound_words[i].counter);
-            }
-        }
+        // best start words are computed on first use
+        best_start_word.assign(words_of_len.size(), -1);
+        guessed_epoch.assign(words.size(), 0);
 
-        // precompute best start word for each length
-        lower_bound.reset_counter();
-        for (char c : ALPHABET)
+        if (guesser_strategy == GuesserStrategy::DECISION_TREE)
         {
-            upper_bound.set_count(c, words_of_len.size());
+            feedback = &index->feedback_matrix();
         }
-        best_start_word = std::vector<int>(words_of_len.size());
-        for (uint i = 0; i < words_of_len.size(); i++)
+        if (guesser_strategy == GuesserStrategy::ENTROPY)
         {
-            if (words_of_len[i].size() > 0)
+            feedback = &index->feedback_matrix();
+            // n_log_n[c] = c * log2(c)
+            n_log_n.resize(MAX_ENTROPY_SECRETS + 1, 0);
+            for (int c = 1; c <= MAX_ENTROPY_SECRETS; c++)
             {
-                best_start_word[i] = compute_highest_score_word(words_of_len[i]);
-                // std::cout << i << " " << words[best_start_word[i]] << "\n";
+                n_log_n[c] = c * std::log2(c);
             }
         }
     }
@@ -163,33 +184,42 @@ struct RandomWordleGuesser
         number_of_guesses = 0;
         know_chars = std::string(word_len, UNKNOWN);
 
-        lower_bound.reset_counter();
-        for (char c : ALPHABET)
+        index->prepare_graph();
+        auto &length_state = index->prepare_length(word_len);
+        lower_bound.fill(0);
+        for (int l = 0; l < ALPHABET_SIZE; l++)
         {
-            int char_bound = upper_bound_words[word_len].get_count(c);
-            upper_bound.set_count(c, char_bound);
+            upper_bound[l] = length_state.upper_bound.get_count(l + 'a');
         }
 
-        letter_not_at_pos.resize(word_len, std::vector<bool>(26, false));
-        for (auto &v : letter_not_at_pos)
+        allowed_letters.assign(word_len, ALL_LETTERS);
+        // a new epoch forgets the guesses of the last game, the stamps are cleared on wrap around
+        if (++guess_epoch == 0)
         {
-            std::fill(v.begin(), v.end(), false);
+            std::fill(guessed_epoch.begin(), guessed_epoch.end(), 0);
+            guess_epoch = 1;
         }
-        guessed_words.clear();
+        has_narrowed_index = false;
     }
 
     void take_hint(WordleHint &hint, std::string &guessed_word)
     {
+        last_pattern = 0;
+        for (int i = (int)hint.size() - 1; i >= 0; i--)
+        {
+            last_pattern = last_pattern * 3 + hint[i];
+        }
         for (uint i = 0; i < hint.size(); i++)
         {
             char c = guessed_word[i];
             if (hint[i] == WordleHintChar::CORRECT_POSITION)
             {
                 know_chars[i] = c;
+                allowed_letters[i] = 1u << (c - 'a');
             }
-            else if (hint[i] == WordleHintChar::DIFFERENT_POSITION)
+            else if (hint[i] == WordleHintChar::DIFFERENT_POSITION && know_chars[i] == UNKNOWN)
             {
-                letter_not_at_pos[i][c - 'a'] = true;
+                allowed_letters[i] &= ~(1u << (c - 'a'));
             }
         }
 
@@ -221,36 +251,36 @@ struct RandomWordleGuesser
                     gray += h == WordleHintChar::DOES_NOT_OCCUR;
                 }
             }
-            int old_bound, bound;
+            int l = c - 'a';
 
             // green and yellow letters have to be at least present
-            old_bound = lower_bound.get_count(c);
-            bound = green + yellow;
-            lower_bound.set_count(c, std::max(old_bound, bound));
+            lower_bound[l] = std::max<int>(lower_bound[l], green + yellow);
 
             // for each free place that is not green
-            old_bound = upper_bound.get_count(c);
-            bound = n - num_known + known_green.get_count(c);
-            upper_bound.set_count(c, std::min(old_bound, bound));
+            upper_bound[l] = std::min<int>(upper_bound[l], n - num_known + known_green.get_count(c));
 
             // if there is a gray letter, not more than the current count of yellow and green is possible
             if (gray > 0)
             {
-                old_bound = upper_bound.get_count(c);
-                bound = green + yellow;
-                upper_bound.set_count(c, std::min(old_bound, bound));
+                upper_bound[l] = std::min<int>(upper_bound[l], green + yellow);
             }
             // std::cout << c << " " << lower_bound.get_count(c) << " " << upper_bound.get_count(c) << "\n";
         }
     }
 
+    // guessed in the current game
+    bool was_guessed(int idx) const
+    {
+        return guessed_epoch[idx] == guess_epoch;
+    }
+
     void remove_already_guessed_words()
     {
         uint i = 0;
         while (i < canditate_index.size())
         {
             int idx = canditate_index[i];
-            if (guessed_words.count(idx) > 0)
+            if (was_guessed(idx))
             {
                 std::swap(canditate_index[i], canditate_index.back());
                 canditate_index.pop_back();
@@ -288,45 +318,56 @@ struct RandomWordleGuesser
     int compute_highest_score_word(std::vector<int> &candidates)
     {
         int word_length = words[candidates[0]].size();
-        int num_words = words_of_len[word_length].size();
         int num_candidates = candidates.size();
-        CharCounter cnt_freq;
-        for (char c : ALPHABET)
+        // skip letter where we already made a guess information
+        uint32_t active = 0;
+        for (int l = 0; l < ALPHABET_SIZE; l++)
         {
-            // skip letter where we already made a guess information
-            if (lower_bound.get_count(c) > 0 || upper_bound.get_count(c) == 0)
-                continue;
-            for (int i = 0; i < num_candidates; i++)
+            if (lower_bound[l] == 0 && upper_bound[l] > 0)
             {
-                int idx = candidates[i];
-                if (letter_cnt_words[idx].get_count(c) > 0)
-                {
-                    cnt_freq.increment(c);
-                }
+                active |= 1u << l;
             }
         }
-        long long sum = std::accumulate(cnt_freq.counter.begin(), cnt_freq.counter.end(), 0);
-        double freq[26];
-        for (int i = 0; i < 26; i++)
+        candidate_masks.resize(num_candidates);
+        for (int i = 0; i < num_candidates; i++)
         {
-            freq[i] = (double)cnt_freq.get_count(i + 'a') / sum;
+            candidate_masks[i] = index->letter_mask(candidates[i]);
         }
+        int cnt_freq[ALPHABET_SIZE];
+        count_letters(candidate_masks.data(), num_candidates, active, cnt_freq);
+        long long sum = std::accumulate(cnt_freq, cnt_freq + ALPHABET_SIZE, 0);
+        if (sum == 0)
+        {
+            // all scores are 0 / 0, a max over (score, index) pairs never finds a larger pair than
+            // the first one as NaN is unordered
+            return words_of_len[word_length][0];
+        }
+        double freq[ALPHABET_SIZE];
+        for (int i = 0; i < ALPHABET_SIZE; i++)
+        {
+            freq[i] = (double)cnt_freq[i] / sum;
+        }
+
+        // score of a word is the sum of the frequencies of its letters, ties go to the larger index
+        auto &masks = index->lengths[word_length].letter_mask;
+        int best = argmax_letter_score(masks.data(), masks.size(), freq);
+        return words_of_len[word_length][best];
+    }
 
-        score_word.resize(num_words);
-        for (int i = 0; i < num_words; i++)
+    int get_best_start_word(int len)
+    {
+        if (best_start_word[len] == -1)
         {
-            int idx = words_of_len[word_length][i];
-            double score = 0;
-            for (int j = 0; j < 26; j++)
-            {
-                int letter_freq = letter_cnt_words[idx].get_count(j + 'a');
-                bool b = letter_freq > 0;
-                score += b * freq[j];
-            }
-            score_word[i] = {score, words_of_len[word_length][i]};
+            // scored without any hint
+            auto lower = lower_bound;
+            auto upper = upper_bound;
+            lower_bound.fill(0);
+            upper_bound.fill(MAX_WORD_LEN);
+            best_start_word[len] = compute_highest_score_word(words_of_len[len]);
+            lower_bound = lower;
+            upper_bound = upper;
         }
-        auto [score, idx] = *std::max_element(score_word.begin(), score_word.end());
-        return idx;
+        return best_start_word[len];
     }
 
     // returns index to word
@@ -334,8 +375,9 @@ struct RandomWordleGuesser
     {
         if (number_of_guesses == 1)
         {
+            visited_nodes = 0;
             canditate_size = words_of_len[word_len].size();
-            return best_start_word[word_len];
+            return get_best_start_word(word_len);
         }
 
         search_candidates();
@@ -353,58 +395,371 @@ struct RandomWordleGuesser
         return compute_highest_score_word(canditate_index);
     }
 
-    std::string make_guess()
+    // sum of c * log2(c) over the number of secrets c that answer the guess with the same pattern,
+    // smaller means more expected information: entropy = log2(n) - sum / n
+    template <typename CodeFunction>
+    double pattern_class_cost(std::vector<int> &secrets, CodeFunction code_of, std::vector<uint64_t> &codes, std::vector<uint16_t> &histogram, bool dense)
+    {
+        int n = secrets.size();
+        codes.resize(n);
+        for (int i = 0; i < n; i++)
+        {
+            codes[i] = code_of(secrets[i]);
+        }
+        return pattern_class_cost(codes, n, histogram, dense);
+    }
+
+    // same for the first n codes
+    template <typename Code>
+    double pattern_class_cost(std::vector<Code> &codes, int n, std::vector<uint16_t> &histogram, bool dense)
+    {
+        double cost = 0;
+        if (dense)
+        {
+            for (int i = 0; i < n; i++)
+            {
+                histogram[codes[i]]++;
+            }
+            // second pass also clears the touched entries
+            for (int i = 0; i < n; i++)
+            {
+                cost += n_log_n[histogram[codes[i]]];
+                histogram[codes[i]] = 0;
+            }
+            return cost;
+        }
+        std::sort(codes.begin(), codes.begin() + n);
+        for (int i = 0, j = 0; i < n; i = j)
+        {
+            while (j < n && codes[j] == codes[i])
+                j++;
+            cost += n_log_n[j - i];
+        }
+        return cost;
+    }
+
+    // guess with the maximal expected information over the secrets, among equally good guesses a
+    // possible secret and then the smaller index is preferred
+    int compute_max_entropy_word(std::vector<int> &guesses, std::vector<int> &secrets, int threads)
+    {
+        int length = words[guesses[0]].size();
+        bool use_table = feedback->has_table(length) && !feedback->table(length).lazy;
+        FeedbackTable *table = use_table ? &feedback->table(length) : nullptr;
+        bool dense = num_pattern_codes(length) <= DENSE_HISTOGRAM_CODES;
+        // without a table all guesses are scored against the secrets by the batched kernel
+        std::unique_ptr<SecretBatch> batch;
+        if (table == nullptr && length <= MAX_BATCH_LENGTH)
+        {
+            batch = std::make_unique<SecretBatch>(words, secrets);
+        }
+
+        std::vector<bool> is_secret(words_of_len[length].size(), false);
+        for (int s : secrets)
+        {
+            is_secret[word_position[s]] = true;
+        }
+        std::vector<int> secret_positions(secrets.size());
+        for (uint i = 0; i < secrets.size(); i++)
+        {
+            secret_positions[i] = word_position[secrets[i]];
+        }
+
+        int num_guesses = guesses.size();
+        std::vector<double> cost(num_guesses);
+        int num_blocks = (num_guesses + ENTROPY_BLOCK_SIZE - 1) / ENTROPY_BLOCK_SIZE;
+        // small sets stay on the calling thread
+        bool parallel = (long long)num_guesses * secrets.size() >= MIN_PARALLEL_ENTROPY_PAIRS;
+        int workers = parallel ? threads : 1;
+        if ((int)entropy_scratch.size() < workers)
+        {
+            entropy_scratch.resize(workers);
+        }
+        parallel_for_each(num_blocks, workers, [&](int b, int w)
+                          {
+            // entries are cleared again by pattern_class_cost
+            auto &[codes, batch_codes, histogram] = entropy_scratch[w];
+            if (dense && histogram.size() < num_pattern_codes(length))
+            {
+                histogram.resize(num_pattern_codes(length), 0);
+            }
+            int end = std::min(num_guesses, (b + 1) * ENTROPY_BLOCK_SIZE);
+            for (int i = b * ENTROPY_BLOCK_SIZE; i < end; i++)
+            {
+                int g = guesses[i];
+                if (batch)
+                {
+                    batch_codes.resize(batch->stride);
+                    batch_pattern_codes(words[g], *batch, batch_codes.data());
+                    cost[i] = pattern_class_cost(batch_codes, batch->n, histogram, dense);
+                }
+                else if (table == nullptr)
+                {
+                    std::string &guess = words[g];
+                    cost[i] = pattern_class_cost(secrets, [&](int s)
+                                                 { return pattern_code(guess, words[s]); }, codes, histogram, dense);
+                }
+                else if (table->code_bytes == 1)
+                {
+                    const uint8_t *row = table->row(word_position[g]);
+                    cost[i] = pattern_class_cost(secret_positions, [&](int s)
+                                                 { return row[s]; }, codes, histogram, dense);
+                }
+                else
+                {
+                    const uint16_t *row = reinterpret_cast<const uint16_t *>(table->row(word_position[g]));
+                    cost[i] = pattern_class_cost(secret_positions, [&](int s)
+                                                 { return row[s]; }, codes, histogram, dense);
+                }
+            } });
+
+        int best = 0;
+        for (int i = 1; i < num_guesses; i++)
+        {
+            bool better = cost[i] < cost[best] || (cost[i] == cost[best] && is_secret[word_position[guesses[i]]] > is_secret[word_position[guesses[best]]]) ||
+                          (cost[i] == cost[best] && is_secret[word_position[guesses[i]]] == is_secret[word_position[guesses[best]]] && guesses[i] < guesses[best]);
+            if (better)
+            {
+                best = i;
+            }
+        }
+        return guesses[best];
+    }
+
+    // scores all words of the length against all candidates, large sets are sampled
+    int guess_by_entropy_of(std::vector<int> &candidates, RandomGenerator &sample_gen, int threads)
+    {
+        std::vector<int> &all_words = words_of_len[word_len];
+        std::vector<int> secrets = candidates;
+        if ((int)secrets.size() > MAX_ENTROPY_SECRETS)
+        {
+            std::sort(secrets.begin(), secrets.end());
+            secrets = sample_gen.n_random_elements(MAX_ENTROPY_SECRETS, secrets);
+        }
+        std::vector<int> guesses = all_words;
+        if ((int)guesses.size() > MAX_ENTROPY_GUESSES)
+        {
+            // the sampled secrets and random other words
+            guesses = secrets;
+            while ((int)guesses.size() < MAX_ENTROPY_GUESSES)
+            {
+                guesses.push_back(sample_gen.random_element(all_words));
+            }
+        }
+        return compute_max_entropy_word(guesses, secrets, threads);
+    }
+
+    // returns index to word
+    int guess_by_entropy()
+    {
+        if (word_len > MAX_PATTERN_LENGTH)
+        {
+            return guess_by_letter_frequency();
+        }
+        if (number_of_guesses == 1)
+        {
+            visited_nodes = 0;
+            canditate_size = words_of_len[word_len].size();
+            // same for every game, fixed seed for the sampling, shared by all guessers of the index
+            return index->entropy_start_word(word_len, [&]()
+                                             {
+                RandomGenerator sample_gen(word_len);
+                return guess_by_entropy_of(words_of_len[word_len], sample_gen, index->num_threads); });
+        }
+
+        search_candidates();
+        remove_already_guessed_words();
+        canditate_size = canditate_index.size();
+
+        if (canditate_size == 0)
+        {
+            return gen.random_element(words_of_len[word_len]);
+        }
+        else if (canditate_size <= 2)
+        {
+            return *std::min_element(canditate_index.begin(), canditate_index.end());
+        }
+        return guess_by_entropy_of(canditate_index, gen, num_threads);
+    }
+
+    // shared by all guessers of the index, so a tree is built and saved only once
+    DecisionTree *get_decision_tree(int len)
+    {
+        return index->decision_tree(len, tree_objective, decision_tree_dir, DECISION_TREE_BEAM_WIDTH);
+    }
+
+    // one child lookup per guess, leaves the tree for letter frequency if a hint has no child
+    int guess_by_decision_tree()
+    {
+        DecisionTree *tree = word_len <= DecisionTree::MAX_LENGTH ? get_decision_tree(word_len) : nullptr;
+        if (tree != nullptr)
+        {
+            if (number_of_guesses == 1)
+            {
+                tree_node = 0;
+            }
+            else if (tree_node != -1)
+            {
+                tree_node = tree->child(tree_node, last_pattern);
+            }
+            if (tree_node != -1)
+            {
+                visited_nodes = 1;
+                canditate_size = tree->nodes[tree_node].num_secrets;
+                return tree->nodes[tree_node].guess;
+            }
+        }
+        return guess_by_letter_frequency();
+    }
+
+    // first and second guess of the entropy strategy, -1 if the book has none; the book maximizes
+    // the expected information, so the other strategies keep their own guesses
+    int guess_from_opening_book()
+    {
+        bool uses_book = guesser_strategy == GuesserStrategy::ENTROPY;
+        if (opening_book == nullptr || !uses_book || number_of_guesses > 2 || !opening_book->has_length(word_len))
+        {
+            return -1;
+        }
+        visited_nodes = 0;
+        if (number_of_guesses == 1)
+        {
+            canditate_size = words_of_len[word_len].size();
+            return opening_book->first_guess[word_len];
+        }
+        auto *entry = opening_book->find_second(word_len, last_pattern);
+        if (entry == nullptr)
+        {
+            return -1;
+        }
+        canditate_size = entry->num_secrets;
+        return entry->guess;
+    }
+
+    int guess_by_strategy()
     {
-        number_of_guesses++;
-        int idx;
         if (guesser_strategy == GuesserStrategy::RANDOM_CANDITATE)
         {
-            idx = guess_random_canditate();
+            return guess_random_canditate();
+        }
+        else if (guesser_strategy == GuesserStrategy::ENTROPY)
+        {
+            return guess_by_entropy();
+        }
+        else if (guesser_strategy == GuesserStrategy::DECISION_TREE)
+        {
+            return guess_by_decision_tree();
         }
         else
         {
-            idx = guess_by_letter_frequency();
+            return guess_by_letter_frequency();
         }
-        guessed_words.insert(idx);
+    }
+
+    std::string make_guess()
+    {
+        number_of_guesses++;
+        int idx = guess_from_opening_book();
+        if (idx == -1)
+        {
+            idx = guess_by_strategy();
+        }
+        guessed_epoch[idx] = guess_epoch;
         return words[idx];
     }
 
-    int missing_letters()
+    // the bitsets of a word length are built on its first search
+    void use_candidate_engine(CandidateEngine engine)
     {
-        int missing = 0;
+        candidate_engine = engine;
+    }
+
+    // builds the lazy parts of the index that the games of this guesser need
+    void prepare_index()
+    {
+        index->prepare_all(candidate_engine == CandidateEngine::BITSET);
+    }
+
+    // hints only remove candidates, so the candidates of the last guess are filtered word by word
+    // as long as that is estimated to be cheaper than the last full search
+    void search_candidates()
+    {
+        long long filter_cost = (long long)narrowed_index.size() * (word_len + ALPHABET_SIZE);
+        if (has_narrowed_index && filter_cost < last_search_cost)
+        {
+            filter_candidates();
+        }
+        else if (candidate_engine == CandidateEngine::BITSET)
+        {
+            search_candidates_bitset();
+            last_search_cost = (long long)visited_nodes * index->candidate_bitsets(word_len).num_blocks;
+        }
+        else
+        {
+            search_candidates_trie();
+            // estimated as a loop over the alphabet at each node
+            last_search_cost = (long long)visited_nodes * ALPHABET_SIZE;
+        }
+        // canditate_index is reordered when guessed words are removed
+        narrowed_index = canditate_index;
+        has_narrowed_index = true;
+    }
+
+    bool is_candidate(int idx)
+    {
+        std::string &w = words[idx];
+        for (int i = 0; i < word_len; i++)
+        {
+            if (!(allowed_letters[i] >> (w[i] - 'a') & 1))
+            {
+                return false;
+            }
+        }
+        auto &cnt = index->letter_count(idx);
         for (char c : ALPHABET)
         {
-            int cnt = found_letters.get_count(c);
-            int lower = lower_bound.get_count(c);
-            int upper = upper_bound.get_count(c);
-            if (cnt <= upper)
+            int k = cnt.get_count(c);
+            if (k < lower_bound[c - 'a'] || k > upper_bound[c - 'a'])
             {
-                missing += std::max(0, lower - cnt);
+                return false;
             }
-            else
+        }
+        return true;
+    }
+
+    // keeps the order, visited_nodes counts the checked words
+    void filter_candidates()
+    {
+        visited_nodes = narrowed_index.size();
+        canditate_index.clear();
+        for (int idx : narrowed_index)
+        {
+            if (is_candidate(idx))
             {
-                // indicates that we prune search
-                return 1e9;
+                canditate_index.push_back(idx);
             }
         }
-        return missing;
     }
 
-    void search_candidates()
+    void search_candidates_trie()
     {
         canditate_index.clear();
         visited_nodes = 0;
-        found_letters.reset_counter();
+        found_letters.fill(0);
+        missing_letters = std::accumulate(lower_bound.begin(), lower_bound.end(), 0);
+        exceeded_letters = 0;
         search_rec(0, 0, false);
     }
 
     void search_rec(int v, int depth, bool is_word)
     {
         visited_nodes++;
-        int missing = missing_letters();
-        if (word_len - depth < missing)
+        if (record_visits)
         {
-            // not enough letter left to fulfill constraints
+            node_visits[v]++;
+        }
+        if (exceeded_letters > 0 || word_len - depth < missing_letters)
+        {
+            // a letter is more often than possible or not enough letter left to fulfill constraints
             return;
         }
         if (depth == word_len)
@@ -422,88 +777,209 @@ struct RandomWordleGuesser
             int w = e.get_id();
             char c = e.get_letter();
             bool is_word = e.is_word();
-            char letter = know_chars[depth];
-
-            // we know letter at this position
-            bool forced_move = c == letter;
+            int l = c - 'a';
+            if (!(allowed_letters[depth] >> l & 1))
+            {
+                continue;
+            }
+            // a known letter is followed even if it exceeds the upper bound, the child prunes then
+            if (know_chars[depth] == UNKNOWN && found_letters[l] + 1 > upper_bound[l])
+            {
+                continue;
+            }
 
-            int new_cnt = found_letters.get_count(c) + 1;
-            int upper = upper_bound.get_count(c);
-            bool search_subtree = letter == UNKNOWN && !letter_not_at_pos[depth][c - 'a'] && new_cnt <= upper;
+            missing_letters -= found_letters[l] < lower_bound[l];
+            exceeded_letters += found_letters[l] == upper_bound[l];
+            found_letters[l]++;
+            search_rec(w, depth + 1, is_word);
+            found_letters[l]--;
+            exceeded_letters -= found_letters[l] == upper_bound[l];
+            missing_letters += found_letters[l] < lower_bound[l];
+        }
+    }
 
-            if (forced_move || search_subtree)
+    // same candidates in the same order as the trie search, visited_nodes counts the combined bitsets
+    void search_candidates_bitset()
+    {
+        auto &bitsets = index->candidate_bitsets(word_len);
+        bitset_operations.clear();
+        for (int i = 0; i < word_len; i++)
+        {
+            if (know_chars[i] != UNKNOWN)
             {
-                found_letters.increment(c);
-                search_rec(w, depth + 1, is_word);
-                found_letters.decrement(c);
+                bitset_operations.push_back({bitsets.letter_at(i, know_chars[i]), false});
+                continue;
+            }
+            for (char c : ALPHABET)
+            {
+                if (!(allowed_letters[i] >> (c - 'a') & 1))
+                {
+                    bitset_operations.push_back({bitsets.letter_at(i, c), true});
+                }
             }
         }
+        for (char c : ALPHABET)
+        {
+            int lower = lower_bound[c - 'a'];
+            int upper = upper_bound[c - 'a'];
+            if (lower > 0)
+            {
+                bitset_operations.push_back({bitsets.at_least(c, lower), false});
+            }
+            if (upper < bitsets.max_count[c - 'a'])
+            {
+                bitset_operations.push_back({bitsets.at_least(c, upper + 1), true});
+            }
+        }
+        bitsets.evaluate(bitset_operations, canditate_index);
+        visited_nodes = bitset_operations.size();
     }
 
     int get_visited_nodes() const { return visited_nodes; }
     int get_canditate_size() const { return canditate_size; }
 
+    void start_recording_visits()
+    {
+        record_visits = true;
+        index->prepare_graph();
+        node_visits.assign(graph.num_nodes(), 0);
+    }
+
+    void stop_recording_visits() { record_visits = false; }
+
+    // node order relative to the trie that packs the recorded hot nodes at the front
+    std::vector<int> compute_profiled_node_order(uint32_t min_visits = 1)
+    {
+        auto profile_order = compute_profile_order(graph, node_visits, 0, min_visits);
+        auto order = index->node_order.empty() ? compute_trie_dfs_order(words) : index->node_order;
+        return compose_orders(order, profile_order);
+    }
+
     const char UNKNOWN = '?';
+    static constexpr uint32_t ALL_LETTERS = (1u << ALPHABET_SIZE) - 1;
+    static constexpr int MAX_ENTROPY_SECRETS = 1024;
+    static constexpr int MAX_ENTROPY_GUESSES = 2048;
+    static constexpr int ENTROPY_BLOCK_SIZE = 32;
+    // guess secret pairs below which the entropy scoring does not start threads
+    static constexpr long long MIN_PARALLEL_ENTROPY_PAIRS = 1 << 16;
+    // 3^10, longer words count patterns by sorting
+    static constexpr uint64_t DENSE_HISTOGRAM_CODES = 59049;
+
     int visited_nodes;
     int canditate_size;
 
+    bool record_visits = false;
+    std::vector<uint32_t> node_visits;
+
     std::vector<int> canditate_index;
-    std::unordered_set<int> guessed_words;
+    // a word was guessed in this game if its stamp is the current epoch
+    std::vector<uint32_t> guessed_epoch;
+    uint32_t guess_epoch = 0;
     std::string know_chars;
 
-    std::vector<CharCounter> upper_bound_words;
-    CharCounter lower_bound;
-    CharCounter upper_bound;
+    // letter counts of the secret, indexed by letter - 'a'
+    std::array<uint8_t, ALPHABET_SIZE> lower_bound;
+    std::array<uint8_t, ALPHABET_SIZE> upper_bound;
+    // bit l is set if letter l is possible at the position
+    std::vector<uint32_t> allowed_letters;
+
+    // state of the trie search, letters on the path and their total shortfall to lower_bound
+    std::array<uint8_t, ALPHABET_SIZE> found_letters;
+    int missing_letters;
+    // letters on the path more often than their upper bound
+    int exceeded_letters;
+
+    CandidateEngine candidate_engine = CandidateEngine::TRIE_SEARCH;
+    std::vector<CandidateBitsets::Operation> bitset_operations;
 
-    CharCounter found_letters;
-    std::vector<std::vector<bool>> letter_not_at_pos;
+    // candidates of the last search before removing guessed words, in search order
+    std::vector<int> narrowed_index;
+    bool has_narrowed_index = false;
+    long long last_search_cost = 0;
 
-    std::vector<CharCounter> letter_cnt_words;
     std::vector<int> best_start_word;
-    std::vector<std::pair<double, int>> score_word;
+    std::vector<uint32_t> candidate_masks;
+
+    // only for the entropy strategy
+    FeedbackMatrix *feedback = nullptr;
+    std::vector<double> n_log_n;
+    // threads of the guesses of this guesser, the shared state of the index uses its own
+    int num_threads = default_num_threads();
+    // buffers of compute_max_entropy_word for each worker thread, kept between guesses
+    struct EntropyScratch
+    {
+        std::vector<uint64_t> codes;
+        std::vector<uint32_t> batch_codes;
+        std::vector<uint16_t> histogram;
+    };
+    std::vector<EntropyScratch> entropy_scratch;
+
+    // first two guesses if set
+    std::shared_ptr<const OpeningBook> opening_book;
+
+    // only for the decision tree strategy
+    static constexpr int DECISION_TREE_BEAM_WIDTH = 4;
+    // trees are stored here if it is not empty
+    std::string decision_tree_dir;
+    TreeObjective tree_objective = TreeObjective::WORST_CASE;
+    int tree_node = -1;
+    uint64_t last_pattern = 0;
 
     int word_len;
     int number_of_guesses;
 
+    std::shared_ptr<BasicWordleIndex<Graph>> index;
     WordList &words;
     RandomGenerator gen;
     GuesserStrategy guesser_strategy;
-    AdjacencyArray<TrieEdge> graph;
-    std::vector<int> node_to_word_index;
-    std::vector<std::vector<int>> words_of_len;
+    Graph &graph;
+    PolicyVector<int> &node_to_word_index;
+    std::vector<std::vector<int>> &words_of_len;
+    std::vector<int> &word_position;
 };
 
-struct WordleSimulation
+template <MembershipIndex WordIndex, TraversableTrieGraph Graph>
+struct BasicWordleSimulation
 {
-    WordleSimulation(WordList &_words, int _max_guesses, int seed, GuesserStrategy strategy) : words(_words), wordle(words), gen(seed), guesser(words, seed + 1, strategy), max_guesses(_max_guesses) {}
+    BasicWordleSimulation(WordList &_words, int _max_guesses, int seed, GuesserStrategy strategy, std::vector<int> node_order = {}, MemoryPolicy policy = MemoryPolicy::DEFAULT_ALLOCATION) : words(_words), wordle(words), gen(seed), guesser(words, seed + 1, strategy, node_order, policy), max_guesses(_max_guesses) {}
+
+    // a new membership index is built if word_index is not set
+    BasicWordleSimulation(std::shared_ptr<BasicWordleIndex<Graph>> index, int _max_guesses, int seed, GuesserStrategy strategy, std::shared_ptr<WordIndex> word_index = nullptr)
+        : words(index->words), wordle(word_index ? BasicWordle<WordIndex>(words, word_index) : BasicWordle<WordIndex>(words)), gen(seed), guesser(index, seed + 1, strategy), max_guesses(_max_guesses) {}
 
     void reset_logging()
     {
         num_guesses = 0;
         visited_nodes.clear();
         canditate_size.clear();
+        guess_time.clear();
         vec_num_guess.clear();
     }
 
-    std::tuple<std::vector<int>, std::vector<std::vector<int>>, std::vector<std::vector<int>>> get_log_data()
+    // number of guesses per game and visited nodes, candidates and time in ns per guess of each game
+    std::tuple<std::vector<int>, std::vector<std::vector<int>>, std::vector<std::vector<int>>, std::vector<std::vector<long long>>> get_log_data()
     {
         std::vector<int> log_guesses = vec_num_guess;
         std::vector<std::vector<int>> log_visited;
         std::vector<std::vector<int>> log_canditates;
+        std::vector<std::vector<long long>> log_time;
         int k = 0;
         auto it_v = visited_nodes.begin();
         auto it_c = canditate_size.begin();
+        auto it_t = guess_time.begin();
         for (auto guesses : log_guesses)
         {
             assert(k + guesses <= (int)visited_nodes.size());
             assert(k + guesses <= (int)canditate_size.size());
             std::vector<int> vis(it_v + k, it_v + k + guesses);
             std::vector<int> cand(it_c + k, it_c + k + guesses);
+            std::vector<long long> time(it_t + k, it_t + k + guesses);
             k += guesses;
             log_visited.push_back(vis);
             log_canditates.push_back(cand);
+            log_time.push_back(time);
         }
-        return {log_guesses, log_visited, log_canditates};
+        return {log_guesses, log_visited, log_canditates, log_time};
     }
 
     void reset()
@@ -529,11 +1005,14 @@ struct WordleSimulation
         for (int i = 0; i < max_guesses; i++)
         {
             num_guesses++;
-            std::string guess = guesser.make_guess();
+            std::string guess;
+            long long time = measureTimeNanoS([&]()
+                                              { guess = guesser.make_guess(); });
             int visited = guesser.get_visited_nodes();
             int canditates = guesser.get_canditate_size();
             visited_nodes.push_back(visited);
             canditate_size.push_back(canditates);
+            guess_time.push_back(time);
             if constexpr (debug)
             {
                 std::cout << "visited nodes: " << visited << "\n";
@@ -578,9 +1057,9 @@ struct WordleSimulation
     }
 
     WordList &words;
-    Wordle wordle;
+    BasicWordle<WordIndex> wordle;
     RandomGenerator gen;
-    RandomWordleGuesser guesser;
+    BasicRandomWordleGuesser<Graph> guesser;
 
     std::string secret_word;
     WordleHint hint;
@@ -590,8 +1069,113 @@ struct WordleSimulation
     std::vector<int> vec_num_guess;
     std::vector<int> visited_nodes;
     std::vector<int> canditate_size;
+    std::vector<long long> guess_time;
+};
+
+// plays a list of games on one simulation per thread over a shared index; the games are split into
+// contiguous shards and game i reseeds the guesser with game_seed(seed, i), so the logged results
+// are the same for every number of threads
+template <MembershipIndex WordIndex, TraversableTrieGraph Graph>
+struct BasicParallelWordleSimulation
+{
+    using Simulation = BasicWordleSimulation<WordIndex, Graph>;
+
+    BasicParallelWordleSimulation(std::shared_ptr<BasicWordleIndex<Graph>> _index, int _max_guesses, int _seed, GuesserStrategy _strategy, int num_threads = default_num_threads())
+        : index(_index), max_guesses(_max_guesses), seed(_seed), strategy(_strategy), sims(num_threads) {}
+
+    static int game_seed(int seed, int game)
+    {
+        return (int)mix_hash((uint64_t)(uint32_t)seed << 32 | (uint32_t)game);
+    }
+
+    // applied to the guesser of each simulation once it is built, e.g. to set the candidate engine
+    void configure_guessers(std::function<void(BasicRandomWordleGuesser<Graph> &)> f)
+    {
+        configure = f;
+    }
+
+    // returns the number of found secrets, found_secret[i] tells if game i of this call was won
+    int play(std::vector<std::string> &secrets)
+    {
+        int num_threads = sims.size();
+        long long n = secrets.size();
+        std::vector<int> found(num_threads, 0);
+        found_secret.assign(n, false);
+        // the shards share the guesser state and the membership index of the dictionary
+        if (!word_index)
+        {
+            word_index = std::make_shared<WordIndex>(index->words);
+        }
+        parallel_for_each(num_threads, num_threads, [&](int t)
+                          {
+            if (!sims[t])
+            {
+                sims[t] = std::make_unique<Simulation>(index, max_guesses, seed, strategy, word_index);
+                if (configure)
+                {
+                    configure(sims[t]->guesser);
+                }
+                // the shards already use all threads
+                if (num_threads > 1)
+                {
+                    sims[t]->guesser.num_threads = 1;
+                }
+            }
+            auto &sim = *sims[t];
+            for (int i = n * t / num_threads; i < n * (t + 1) / num_threads; i++)
+            {
+                sim.guesser.gen = RandomGenerator(game_seed(seed, i));
+                found_secret[i] = sim.template play_one_round<false>(secrets[i]);
+                found[t] += found_secret[i];
+            } });
+        return std::accumulate(found.begin(), found.end(), 0);
+    }
+
+    // same as BasicWordleSimulation::get_log_data over the games of all shards in input order
+    std::tuple<std::vector<int>, std::vector<std::vector<int>>, std::vector<std::vector<int>>, std::vector<std::vector<long long>>> get_log_data()
+    {
+        std::vector<int> log_guesses;
+        std::vector<std::vector<int>> log_visited;
+        std::vector<std::vector<int>> log_canditates;
+        std::vector<std::vector<long long>> log_time;
+        for (auto &sim : sims)
+        {
+            if (!sim)
+                continue;
+            auto [guesses, visited, canditates, time] = sim->get_log_data();
+            log_guesses.insert(log_guesses.end(), guesses.begin(), guesses.end());
+            log_visited.insert(log_visited.end(), visited.begin(), visited.end());
+            log_canditates.insert(log_canditates.end(), canditates.begin(), canditates.end());
+            log_time.insert(log_time.end(), time.begin(), time.end());
+        }
+        return {log_guesses, log_visited, log_canditates, log_time};
+    }
+
+    void reset_logging()
+    {
+        for (auto &sim : sims)
+        {
+            if (sim)
+                sim->reset_logging();
+        }
+    }
+
+    std::shared_ptr<BasicWordleIndex<Graph>> index;
+    std::shared_ptr<WordIndex> word_index;
+    int max_guesses;
+    int seed;
+    GuesserStrategy strategy;
+    std::function<void(BasicRandomWordleGuesser<Graph> &)> configure;
+    std::vector<std::unique_ptr<Simulation>> sims;
+    // char instead of bool, the shards write concurrently
+    std::vector<char> found_secret;
 };
 
+using RandomWordleGuesser = BasicRandomWordleGuesser<AdjacencyArray<TrieEdge>>;
+using WordleSimulation = BasicWordleSimulation<Trie, AdjacencyArray<TrieEdge>>;
+using WordleIndex = BasicWordleIndex<AdjacencyArray<TrieEdge>>;
+using ParallelWordleSimulation = BasicParallelWordleSimulation<Trie, AdjacencyArray<TrieEdge>>;
+
 void find_best_start_word(WordList &words, int len)
 {
     Wordle wordle(words);
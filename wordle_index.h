@@ -0,0 +1,238 @@
+#pragma once
+
+#include <vector>
+#include <string>
+#include <memory>
+#include <mutex>
+#include <iostream>
+#include <algorithm>
+
+#include "common.h"
+#include "static_trie.h"
+#include "graph.h"
+#include "concepts.h"
+#include "feedback.h"
+#include "decision_tree.h"
+#include "measure_time.h"
+#include "candidate_bitsets.h"
+#include "letter_masks.h"
+
+// the part of the wordle guesser that only depends on the dictionary, shared by all guessers of
+// one dictionary; the trie is built on the first game and the state of a word length on the
+// first game of that length, both may happen concurrently from several guessers
+template <TraversableTrieGraph Graph>
+struct BasicWordleIndex
+{
+    struct LengthState
+    {
+        // letter counts and letter masks in the order of words_of_len
+        std::vector<CharCounter> letter_cnt;
+        std::vector<uint32_t> letter_mask;
+        CharCounter upper_bound;
+        std::unique_ptr<CandidateBitsets> bitsets;
+        int entropy_start_word = -1;
+    };
+
+    // node order maps trie node ids to graph ids, if it is empty the graph is dfs ordered
+    BasicWordleIndex(WordList &_words, std::vector<int> _node_order = {}, MemoryPolicy _policy = MemoryPolicy::DEFAULT_ALLOCATION)
+        : words(_words), node_order(_node_order), policy(_policy)
+    {
+        record_phase("index words by length", [&]()
+                     {
+            words_of_len = compute_index_word_of_len(words);
+            word_position.resize(words.size());
+            for (auto &index : words_of_len)
+            {
+                for (uint i = 0; i < index.size(); i++)
+                {
+                    word_position[index[i]] = i;
+                }
+            } });
+        lengths.resize(words_of_len.size());
+        length_once = std::make_unique<std::once_flag[]>(words_of_len.size());
+        bitset_once = std::make_unique<std::once_flag[]>(words_of_len.size());
+        entropy_start_once = std::make_unique<std::once_flag[]>(words_of_len.size());
+        decision_trees.resize(NUM_TREE_OBJECTIVES * words_of_len.size());
+        decision_tree_once = std::make_unique<std::once_flag[]>(NUM_TREE_OBJECTIVES * words_of_len.size());
+    }
+
+    void prepare_graph()
+    {
+        std::call_once(graph_once, [&]()
+                       { record_phase("trie graph", [&]()
+                                      {
+            graph = build_trie_graph<Graph>(words, node_order, policy);
+            node_to_word_index = construct_node_to_word_index(graph, words, policy); }); });
+    }
+
+    LengthState &prepare_length(int len)
+    {
+        assert(len < (int)words_of_len.size() && words_of_len[len].size() > 0);
+        std::call_once(length_once[len], [&]()
+                       { record_phase("letter counts of length " + std::to_string(len), [&]()
+                                      { compute_length_state(len); }); });
+        return lengths[len];
+    }
+
+    // builds the trie and the state of every length up front, e.g. so that timed games do not
+    // include it; the bitsets only if the candidates are searched with them
+    void prepare_all(bool bitsets)
+    {
+        prepare_graph();
+        for (int len = 0; len < (int)words_of_len.size(); len++)
+        {
+            if (words_of_len[len].empty())
+                continue;
+            prepare_length(len);
+            if (bitsets)
+            {
+                candidate_bitsets(len);
+            }
+        }
+    }
+
+    CandidateBitsets &candidate_bitsets(int len)
+    {
+        assert(len < (int)words_of_len.size() && words_of_len[len].size() > 0);
+        std::call_once(bitset_once[len], [&]()
+                       { record_phase("candidate bitsets of length " + std::to_string(len), [&]()
+                                      { lengths[len].bitsets = std::make_unique<CandidateBitsets>(words, words_of_len[len]); }); });
+        return *lengths[len].bitsets;
+    }
+
+    // first guess of the entropy strategy, the same for every game of the length, computed by
+    // compute of the first guesser that needs it
+    template <typename Function>
+    int entropy_start_word(int len, Function compute)
+    {
+        assert(len < (int)words_of_len.size() && words_of_len[len].size() > 0);
+        std::call_once(entropy_start_once[len], [&]()
+                       { record_phase("entropy start word of length " + std::to_string(len), [&]()
+                                      { lengths[len].entropy_start_word = compute(); }); });
+        return lengths[len].entropy_start_word;
+    }
+
+    FeedbackMatrix &feedback_matrix()
+    {
+        std::call_once(feedback_once, [&]()
+                       { feedback = std::make_unique<FeedbackMatrix>(words); });
+        return *feedback;
+    }
+
+    // built on first use, or loaded from dir if it holds a tree of this dictionary and saved there;
+    // nullptr if the feedback table of the length is too large
+    DecisionTree *decision_tree(int len, TreeObjective objective, std::string &dir, int beam_width)
+    {
+        assert(len < (int)words_of_len.size());
+        int slot = objective * words_of_len.size() + len;
+        std::call_once(decision_tree_once[slot], [&]()
+                       {
+            auto &feedback = feedback_matrix();
+            if (!feedback.has_table(len) || feedback.table(len).lazy)
+            {
+                return;
+            }
+            record_phase("decision tree of length " + std::to_string(len), [&]()
+                         {
+                auto &table = feedback.table(len);
+                uint64_t hash = table.dictionary_hash();
+                std::string path = dir + "/decision_tree_" + std::to_string(len) + ".bin";
+                auto tree = std::make_unique<DecisionTree>();
+                if (dir.empty() || !tree->load(path, len, objective, hash, words))
+                {
+                    DecisionTreeSolver solver(table, objective, beam_width, num_threads);
+                    *tree = solver.solve();
+                    if (!dir.empty())
+                    {
+                        tree->save(path, hash);
+                    }
+                }
+                decision_trees[slot] = std::move(tree); }); });
+        return decision_trees[slot].get();
+    }
+
+    // the length of the word must be prepared
+    CharCounter &letter_count(int idx)
+    {
+        return lengths[words[idx].size()].letter_cnt[word_position[idx]];
+    }
+
+    uint32_t letter_mask(int idx)
+    {
+        return lengths[words[idx].size()].letter_mask[word_position[idx]];
+    }
+
+    void compute_length_state(int len)
+    {
+        auto &state = lengths[len];
+        auto &index = words_of_len[len];
+        state.letter_cnt.resize(index.size());
+        state.letter_mask.resize(index.size());
+        for (uint i = 0; i < index.size(); i++)
+        {
+            state.letter_cnt[i].new_counter(words[index[i]]);
+            state.letter_mask[i] = ::letter_mask(words[index[i]]);
+        }
+
+        // maximal upper bound of the length
+        int bound = 0;
+        for (char c : ALPHABET)
+        {
+            for (auto &cnt : state.letter_cnt)
+            {
+                bound = std::max(bound, cnt.get_count(c));
+            }
+            state.upper_bound.set_count(c, bound);
+        }
+    }
+
+    template <typename Function>
+    void record_phase(std::string name, Function f)
+    {
+        int time = measureTimeMicroS(f);
+        std::lock_guard<std::mutex> lock(phase_mutex);
+        phase_times.push_back({name, time});
+    }
+
+    // phases in the order they finished
+    void print_phase_times()
+    {
+        std::lock_guard<std::mutex> lock(phase_mutex);
+        std::cout << "startup phase time[us]\n";
+        for (auto &[name, time] : phase_times)
+        {
+            std::cout << name << " " << time << "\n";
+        }
+    }
+
+    WordList &words;
+    std::vector<int> node_order;
+    MemoryPolicy policy;
+    // threads of the shared builds, independent of the threads of the guessers, which are 1 in
+    // simulation shards
+    int num_threads = default_num_threads();
+
+    std::vector<std::vector<int>> words_of_len;
+    // position of each word in words_of_len
+    std::vector<int> word_position;
+
+    Graph graph;
+    PolicyVector<int> node_to_word_index;
+    std::once_flag graph_once;
+
+    std::vector<LengthState> lengths;
+    std::unique_ptr<std::once_flag[]> length_once;
+    std::unique_ptr<std::once_flag[]> bitset_once;
+    std::unique_ptr<std::once_flag[]> entropy_start_once;
+
+    std::unique_ptr<FeedbackMatrix> feedback;
+    std::once_flag feedback_once;
+
+    // indexed by objective * words_of_len.size() + length
+    static constexpr int NUM_TREE_OBJECTIVES = 2;
+    std::vector<std::unique_ptr<DecisionTree>> decision_trees;
+    std::unique_ptr<std::once_flag[]> decision_tree_once;
+
+    std::mutex phase_mutex;
+    std::vector<std::pair<std::string, int>> phase_times;
+};